@@ -173,7 +173,7 @@ PyObject* Teng_Teng(TengObject *self, PyObject *args, PyObject *keywds) {
     static const char *kwlist[] = {"root", "encoding", "contentType",
                                    "logToOutput", "errorFragment",
                                    "validate", "templateCacheSize",
-                                   "dictionaryCacheSize", 0};
+                                   "dictionaryCacheSize", "logLevel", 0};
 
     // argument values
     const char *root = 0;
@@ -184,18 +184,21 @@ PyObject* Teng_Teng(TengObject *self, PyObject *args, PyObject *keywds) {
     int validate = 0;
     int templateCacheSize = 0;
     int dictionaryCacheSize = 0;
+    int logLevel = Error_t::LL_DEBUGING;
 
     // parse arguments
-    if (!PyArg_ParseTupleAndKeywords(args, keywds, "|zzziiiii:Teng",
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "|zzziiiiii:Teng",
                                     (char **)kwlist,
                                      &root, &encoding, &contentType,
                                      &logToOutput, &errorFragment,
                                      &validate, &templateCacheSize,
-                                     &dictionaryCacheSize))
+                                     &dictionaryCacheSize, &logLevel))
         return 0;
 
     if (templateCacheSize < 0) templateCacheSize = 0;
     if (dictionaryCacheSize < 0) dictionaryCacheSize = 0;
+    if (logLevel < Error_t::LL_DEBUGING) logLevel = Error_t::LL_DEBUGING;
+    if (logLevel > Error_t::LL_FATAL) logLevel = Error_t::LL_FATAL;
 
 #if (MY_PYTHON_VER < 20)
     // create new memory for object
@@ -211,6 +214,7 @@ PyObject* Teng_Teng(TengObject *self, PyObject *args, PyObject *keywds) {
     // create settings
     Teng_t::Settings_t settings(0, false, templateCacheSize,
                                 dictionaryCacheSize);
+    settings.logLevel = static_cast<Error_t::Level_t>(logLevel);
 
     try {
         // create teng object
@@ -573,6 +577,8 @@ static char Teng_Teng__doc__[] =
 "                              cache.\n"
 "    dictionaryCacheSize       Specifies maximal number of dictionaries\n"
 "                              in the cache.\n"
+"    logLevel                  Errors with lower level are not logged\n"
+"                              (0 debug, 1 warning, 2 error, 3 fatal).\n"
 ;
 
 static char Teng_generatePage__doc__[] =
@@ -46,6 +46,7 @@
 #include "tengfilesystem.h"
 #include "tengstructs.h"
 #include "tengprocessor.h"
+#include "tengfragmentstack.h"
 #include "tengcontenttype.h"
 #include "tengtemplate.h"
 #include "tengformatter.h"
@@ -86,7 +87,9 @@ static int logErrors(const ContentType_t *contentType,
 }
 
 Teng_t::Teng_t(const std::string &root, const Teng_t::Settings_t &settings)
-    : root(root), filesystem(new Filesystem_t()), templateCache(0), err()
+    : root(root), filesystem(new Filesystem_t()), templateCache(0),
+      fragmentStorage(new FragmentStorage_t()), logLevel(settings.logLevel),
+      err()
 {
     init(settings);
 }
@@ -94,7 +97,9 @@ Teng_t::Teng_t(const std::string &root, const Teng_t::Settings_t &settings)
 Teng_t::Teng_t(const std::string &root,
                const Settings_t &settings,
                FilesystemInterface_t *filesystem)
-    : root(root), filesystem(filesystem), templateCache(0), err()
+    : root(root), filesystem(filesystem), templateCache(0),
+      fragmentStorage(new FragmentStorage_t()), logLevel(settings.logLevel),
+      err()
 {
     init(settings);
 }
@@ -120,6 +125,7 @@ void Teng_t::init(const Settings_t &settings)
 
 Teng_t::~Teng_t() {
     delete templateCache;
+    delete fragmentStorage;
     delete filesystem;
 }
 
@@ -147,6 +153,27 @@ std::string prependBeforeExt(const std::string &str, const std::string &prep) {
     }
 }
 
+/** @short Raises minimal level of error log for its lifetime.
+ */
+class MinLevelGuard_t {
+public:
+    MinLevelGuard_t(Error_t &err, Error_t::Level_t level,
+                    Error_t::Level_t configLevel)
+        : err(err), saved(err.getMinLevel())
+    {
+        if (configLevel > level) level = configLevel;
+        if (level > saved) err.setMinLevel(level);
+    }
+
+    ~MinLevelGuard_t() {
+        err.setMinLevel(saved);
+    }
+
+private:
+    Error_t &err;
+    Error_t::Level_t saved;
+};
+
 } // namespace
 
 int Teng_t::generatePage(const std::string &templateFilename,
@@ -173,18 +200,29 @@ int Teng_t::generatePage(const std::string &templateFilename,
                              langDictFilename, param,
                              TemplateCache_t::SRC_FILE));
 
+    // drop errors below configured level
+    MinLevelGuard_t minLevelGuard(err, logLevel,
+                                  templ->paramDictionary->getLogLevel());
+
     // append error logs of dicts and program
-    err.append(templ->langDictionary->getErrors());
-    err.append(templ->paramDictionary->getErrors());
-    err.append(templ->program->getErrors());
+    err.appendShared(templ->langDictionary->getErrors());
+    err.appendShared(templ->paramDictionary->getErrors());
+    err.appendShared(templ->program->getErrors());
 
     // if program is valid (not empty) execute it
     if (!templ->program->empty()) {
-        Formatter_t output(writer);
+        Formatter_t output(writer, Formatter_t::MODE_PASSWHITE,
+                           templ->paramDictionary->getFlushThreshold());
+
+        // prepare room for expected output
+        writer.reserve(templ->getOutputSizeEstimate());
 
         Processor_t(*templ->program, *templ->langDictionary,
                     *templ->paramDictionary, encoding,
-                    contentType).run(data, output, err);
+                    contentType).run(data, output, err, fragmentStorage);
+
+        // remember size of output for next run
+        templ->updateOutputSizeEstimate(output.getWritten());
     }
 
     // log error into log, if said
@@ -223,20 +261,31 @@ int Teng_t::generatePage(const std::string &templateString,
                 (templateString, langDictFilename,
                  param, TemplateCache_t::SRC_STRING));
 
+    // drop errors below configured level
+    MinLevelGuard_t minLevelGuard(err, logLevel,
+                                  templ->paramDictionary->getLogLevel());
+
     // append error logs of dicts and program
-    err.append(templ->langDictionary->getErrors());
-    err.append(templ->paramDictionary->getErrors());
-    err.append(templ->program->getErrors());
+    err.appendShared(templ->langDictionary->getErrors());
+    err.appendShared(templ->paramDictionary->getErrors());
+    err.appendShared(templ->program->getErrors());
 
     // if program is valid (not empty) execute it
     if (!templ->program->empty()) {
         // create formatter for writer
-        Formatter_t output(writer);
+        Formatter_t output(writer, Formatter_t::MODE_PASSWHITE,
+                           templ->paramDictionary->getFlushThreshold());
+
+        // prepare room for expected output
+        writer.reserve(templ->getOutputSizeEstimate());
 
         // execute byte code
         Processor_t(*templ->program, *templ->langDictionary,
                     *templ->paramDictionary, encoding,
-                    contentType).run(data, output, err);
+                    contentType).run(data, output, err, fragmentStorage);
+
+        // remember size of output for next run
+        templ->updateOutputSizeEstimate(output.getWritten());
     }
 
     // log error into log, if said
@@ -253,6 +302,70 @@ int Teng_t::generatePage(const std::string &templateString,
     return err.getLevel();
 }
 
+int Teng_t::getDataUsage(const std::string &templateFilename,
+                         const std::string &skin,
+                         const std::string &_dict,
+                         const std::string &lang,
+                         const std::string &param,
+                         DataUsage_t &usage,
+                         Error_t &err)
+{
+    // make proper filename for language dictionary
+    std::string langDictFilename = prependBeforeExt(_dict, lang);
+
+    std::auto_ptr<Template_t>
+        templ(templateCache->
+              createTemplate(prependBeforeExt(templateFilename, skin),
+                             langDictFilename, param,
+                             TemplateCache_t::SRC_FILE));
+
+    // drop errors below configured level
+    MinLevelGuard_t minLevelGuard(err, logLevel,
+                                  templ->paramDictionary->getLogLevel());
+
+    // append error logs of dicts and program
+    err.appendShared(templ->langDictionary->getErrors());
+    err.appendShared(templ->paramDictionary->getErrors());
+    err.appendShared(templ->program->getErrors());
+
+    // copy usage computed by compiler
+    usage = templ->program->getDataUsage();
+
+    // return error level from error log
+    return err.getLevel();
+}
+
+int Teng_t::getDataUsage(const std::string &templateString,
+                         const std::string &dict,
+                         const std::string &lang,
+                         const std::string &param,
+                         DataUsage_t &usage,
+                         Error_t &err)
+{
+    // make proper filename for language dictionary
+    std::string langDictFilename = prependBeforeExt(dict, lang);
+
+    std::auto_ptr<Template_t>
+        templ(templateCache->createTemplate
+                (templateString, langDictFilename,
+                 param, TemplateCache_t::SRC_STRING));
+
+    // drop errors below configured level
+    MinLevelGuard_t minLevelGuard(err, logLevel,
+                                  templ->paramDictionary->getLogLevel());
+
+    // append error logs of dicts and program
+    err.appendShared(templ->langDictionary->getErrors());
+    err.appendShared(templ->paramDictionary->getErrors());
+    err.appendShared(templ->program->getErrors());
+
+    // copy usage computed by compiler
+    usage = templ->program->getDataUsage();
+
+    // return error level from error log
+    return err.getLevel();
+}
+
 int Teng_t::dictionaryLookup(const std::string &config,
                              const std::string &dict,
                              const std::string &lang,
@@ -45,12 +45,14 @@
 #include <tengstructs.h>
 #include <tengwriter.h>
 #include <tengerror.h>
+#include <tengdatausage.h>
 #include <tengconfig.h>
 
 namespace Teng {
 
 class TemplateCache_t;
 class FilesystemInterface_t;
+class FragmentStorage_t;
 
 /** @short Templating engine.
  */
@@ -62,7 +64,7 @@ public:
         inline Settings_t(unsigned int programCacheSize = 0,
                           unsigned int dictCacheSize = 0)
             : programCacheSize(programCacheSize),
-              dictCacheSize(dictCacheSize)
+              dictCacheSize(dictCacheSize), logLevel(Error_t::LL_DEBUGING)
         {
             // no-op
         }
@@ -71,13 +73,18 @@ public:
                           unsigned int programCacheSize = 0,
                           unsigned int dictCacheSize = 0)
             : programCacheSize(programCacheSize),
-              dictCacheSize(dictCacheSize)
+              dictCacheSize(dictCacheSize), logLevel(Error_t::LL_DEBUGING)
         {
             // no-op
         }
 
         unsigned int programCacheSize;
         unsigned int dictCacheSize;
+
+        /** @short Errors with lower level are not logged (the higher
+         *         of this and configuration's %loglevel is used).
+         */
+        Error_t::Level_t logLevel;
     };
 
     /** @short Create new engine.
@@ -137,6 +144,36 @@ public:
                      const std::string &encoding, const Fragment_t &data,
                      Writer_t &writer, Error_t &err);
 
+    /** @short Get data paths the file template can access.
+     *  @param templateFilename file with main template
+     *  @param skin skin of template
+     *  @param dict language dictionary
+     *  @param lang language
+     *  @param param config (dictionary with non language data)
+     *  @param usage found data usage
+     *  @param err error log
+     *  @return 0 OK, !0 error
+     */
+    int getDataUsage(const std::string &templateFilename,
+                     const std::string &skin,
+                     const std::string &dict, const std::string &lang,
+                     const std::string &param, DataUsage_t &usage,
+                     Error_t &err);
+
+    /** @short Get data paths the string template can access.
+     *  @param templateString main template
+     *  @param dict language dictionary
+     *  @param lang language
+     *  @param param config (dictionary with non language data)
+     *  @param usage found data usage
+     *  @param err error log
+     *  @return 0 OK, !0 error
+     */
+    int getDataUsage(const std::string &templateString,
+                     const std::string &dict, const std::string &lang,
+                     const std::string &param, DataUsage_t &usage,
+                     Error_t &err);
+
     /** @short Find entry in dictionary.
      *  @param config config dictionary path
      *  @param dict language dictionary path
@@ -193,6 +230,14 @@ private:
      */
     TemplateCache_t *templateCache;
 
+    /** @short Storage of fragment frames reused by subsequent runs.
+     */
+    FragmentStorage_t *fragmentStorage;
+
+    /** @short Minimal level of logged errors.
+     */
+    Error_t::Level_t logLevel;
+
     /** @short Error log.
      */
     Error_t err;
@@ -95,7 +95,7 @@ public:
                 unsigned long int serial,
                 unsigned long int dependSerial)
             : data(data), refCount(1), serial(serial), dependSerial(dependSerial),
-              valid(true), key(key)
+              valid(true), key(key), estimate(0)
         {}
 
         /**
@@ -131,6 +131,11 @@ public:
          */
         const Key_t key;
 
+        /** @short Size estimate kept for the data by cache owner
+         *         (e.g. size of page generated by program, 0 = unknown).
+         */
+        unsigned long int estimate;
+
    private:
         /**
          * @short Copy constructor intentionally private -- copying
@@ -322,6 +327,31 @@ public:
         return data;
     }
 
+    /**
+     * @short Get size estimate kept for cached data.
+     *
+     * @param data pointer to data
+     * @return estimate or 0 when unknown
+     */
+    unsigned long int getEstimate(const DataType_t *data) const {
+        typename EntryBackCache_t::const_iterator fbackcache
+            = backcache.find(data);
+        return (fbackcache == backcache.end())
+            ? 0 : fbackcache->second->estimate;
+    }
+
+    /**
+     * @short Set size estimate kept for cached data.
+     *
+     * @param data pointer to data
+     * @param estimate new estimate
+     */
+    void setEstimate(const DataType_t *data, unsigned long int estimate) {
+        typename EntryBackCache_t::iterator fbackcache = backcache.find(data);
+        if (fbackcache != backcache.end())
+            fbackcache->second->estimate = estimate;
+    }
+
     /**
      * @short Releases entry.
      *
@@ -38,6 +38,8 @@
 #include "tenginstruction.h"
 #include "tengparservalue.h"
 #include "tengcode.h"
+#include "tengformatter.h"
+#include "tengwriter.h"
 
 
 namespace Teng {
@@ -118,6 +120,35 @@ void tengCode_generatePrint(ParserContext_t *context)
         // no way, simply add print instruction
         tengCode_generate(context, Instruction_t::PRINT);
     }
+
+    // pre-format static text inside format block
+    prgsize = context->program->size();
+    if (!context->formatModes.empty()
+            && context->paramDictionary->isFormatEnabled()
+            && context->formatModes.top() != Formatter_t::MODE_PASSWHITE
+            && prgsize >= 2
+            && (*context->program)[prgsize - 2].operation
+            == Instruction_t::VAL) {
+        ParserValue_t &val = (*context->program)[prgsize - 2].value;
+        std::string::size_type first
+            = val.stringValue.find_first_not_of(" \t\n\v\f\r");
+        if (first != std::string::npos) {
+            // leading and trailing whitespaces can join with adjacent
+            // output at runtime => format only inner part of text
+            std::string::size_type last
+                = val.stringValue.find_last_not_of(" \t\n\v\f\r") + 1;
+            std::string text(val.stringValue, 0, first);
+            {
+                StringWriter_t writer(text);
+                Formatter_t formatter(writer, context->formatModes.top());
+                formatter.write(val.stringValue.substr(first, last - first));
+            }
+            text.append(val.stringValue, last, std::string::npos);
+            val.setString(text);
+            // tell processor that VAL preceding PRINT is pre-formatted
+            (*context->program)[prgsize - 1].value.integerValue = 1;
+        }
+    }
 }
 
 
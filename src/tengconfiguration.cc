@@ -47,7 +47,8 @@ Configuration_t::Configuration_t(const std::string &root)
     : Dictionary_t(root), debug(false), errorFragment(false),
       logToOutput(false), bytecode(false), watchFiles(true),
       alwaysEscape(true), shortTag(false), maxIncludeDepth(10),
-      format(true), maxDebugValLength(40)
+      maxRepeatDepth(64), format(true), maxDebugValLength(40), flushThreshold(0),
+      flushOnFrag(false), logLevel(Error_t::LL_DEBUGING)
 {}
 
 Configuration_t::~Configuration_t() {
@@ -96,6 +97,28 @@ int Configuration_t::processDirective(const FilesystemInterface_t *filesystem,
         return 0;
     }
 
+    if (directive == "maxrepeatdepth") {
+        if (argument.empty()) {
+            err.logError(Error_t::LL_ERROR, pos,
+                         "Invalid value of max-repeat-depth '"
+                         + argument + "'");
+            return -1;
+        }
+
+        // convert to unsigned int
+        char *end;
+        unsigned long int depth = strtoul(argument.c_str(), &end, 10);
+        if (*end) {
+            err.logError(Error_t::LL_ERROR, pos,
+                         "Invalid value of max-repeat-depth '"
+                         + argument + "'");
+            return -1;
+        }
+
+        maxRepeatDepth = depth;
+        return 0;
+    }
+
     if (directive == "maxdebugvallength") {
         if (argument.empty()) {
             err.logError(Error_t::LL_ERROR, pos,
@@ -118,6 +141,41 @@ int Configuration_t::processDirective(const FilesystemInterface_t *filesystem,
         return 0;
     }
 
+    if (directive == "flushthreshold") {
+        if (argument.empty()) {
+            err.logError(Error_t::LL_ERROR, pos,
+                         "Invalid value of flush-threshold '"
+                         + argument + "'");
+            return -1;
+        }
+
+        // convert to unsigned int
+        char *end;
+        unsigned long int threshold = strtoul(argument.c_str(), &end, 10);
+        if (*end) {
+            err.logError(Error_t::LL_ERROR, pos,
+                         "Invalid value of flush-threshold '"
+                         + argument + "'");
+            return -1;
+        }
+
+        flushThreshold = threshold;
+        return 0;
+    }
+
+    if (directive == "loglevel") {
+        if (argument == "debug") logLevel = Error_t::LL_DEBUGING;
+        else if (argument == "warning") logLevel = Error_t::LL_WARNING;
+        else if (argument == "error") logLevel = Error_t::LL_ERROR;
+        else if (argument == "fatal") logLevel = Error_t::LL_FATAL;
+        else {
+            err.logError(Error_t::LL_ERROR, pos,
+                         "Invalid value of log-level '" + argument + "'");
+            return -1;
+        }
+        return 0;
+    }
+
 
     // enable/disable
 
@@ -137,6 +195,7 @@ int Configuration_t::processDirective(const FilesystemInterface_t *filesystem,
     else if (argument == "format") format = value;
     else if (argument == "alwaysescape") alwaysEscape = value;
     else if (argument == "shorttag") shortTag = value;
+    else if (argument == "flushonfrag") flushOnFrag = value;
     else {
         err.logError(Error_t::LL_ERROR, pos,
                      "Invalid enable/disable argument '" + argument + "'");
@@ -158,6 +217,7 @@ int Configuration_t::isEnabled(const std::string &feature,
     else if (feature == "format") enabled = format;
     else if (feature == "alwaysescape") enabled = alwaysEscape;
     else if (feature == "shortag") enabled = shortTag;
+    else if (feature == "flushonfrag") enabled = flushOnFrag;
     else return -1;
 
     // OK
@@ -180,10 +240,14 @@ std::ostream& operator<<(std::ostream &o, const Configuration_t &c) {
       << "    bytecode: " << ENABLED(c.bytecode) << std::endl
       << "    watchfiles: " << ENABLED(c.watchFiles) << std::endl
       << "    maxincludedepth: " << c.maxIncludeDepth << std::endl
+      << "    maxrepeatdepth: " << c.maxRepeatDepth << std::endl
       << "    maxdebugvallength: " << c.maxDebugValLength << std::endl
       << "    format: " << ENABLED(c.format) << std::endl
       << "    alwaysescape: " << ENABLED(c.alwaysEscape) << std::endl
-      << "    shorttag: " << ENABLED(c.shortTag) << std::endl;
+      << "    shorttag: " << ENABLED(c.shortTag) << std::endl
+      << "    flushthreshold: " << c.flushThreshold << std::endl
+      << "    flushonfrag: " << ENABLED(c.flushOnFrag) << std::endl
+      << "    loglevel: " << c.logLevel << std::endl;
 
     return o;
 }
@@ -99,6 +99,10 @@ public:
         return maxIncludeDepth;
     }
 
+    inline unsigned int getMaxRepeatDepth() const {
+        return maxRepeatDepth;
+    }
+
     inline unsigned int getMaxDebugValLength() const {
         return maxDebugValLength;
     }
@@ -115,6 +119,18 @@ public:
         return shortTag;
     }
 
+    inline unsigned int getFlushThreshold() const {
+        return flushThreshold;
+    }
+
+    inline bool isFlushOnFragEnabled() const {
+        return flushOnFrag;
+    }
+
+    inline Error_t::Level_t getLogLevel() const {
+        return logLevel;
+    }
+
     int isEnabled(const std::string &feature, bool &enabled) const;
 
     friend std::ostream& operator<<(std::ostream &o, const Configuration_t &c);
@@ -129,9 +145,13 @@ private:
     bool shortTag;         //!< Short tags <? ?> enabled (false)
 
     unsigned int maxIncludeDepth; //!< Maximal template include depth.
+    unsigned int maxRepeatDepth; //!< Maximal <?teng repeatfrag?> depth.
 
     bool format;          //!< enabled <?tenf formag ...?> (true)
     unsigned short int maxDebugValLength; //!< Maximal length of variable value length
+    unsigned int flushThreshold; //!< Flush writer after so many bytes (0 = never)
+    bool flushOnFrag;     //!< Flush writer when outermost fragment is entered (false)
+    Error_t::Level_t logLevel; //!< Errors below are dropped (LL_DEBUGING)
 };
 
 } // namespace Teng
@@ -157,14 +157,14 @@ ContentType_t::Descriptor_t *unknown = init_descriptors();
 
 ContentType_t::ContentType_t()
     : lineComment(), blockComment(), escapes(),
-      unescaper()
+      unescaper(), unescapeStart(-1)
 {
     // set escape bitmap to all -1 (character not escaped)
     int *end = escapeBitmap + 256;
     int *i = escapeBitmap;
     while (i != end) *i++ = -1;
     // create empty automaton
-    unescaper.push_back(std::pair<int, int>(0, 0));
+    unescaper.resize(256, 0);
 }
 
 int ContentType_t::addEscape(unsigned char c, const std::string &escape) {
@@ -195,22 +195,52 @@ std::string ContentType_t::escape(const std::string &src) const {
     return dest;
 }
 
+bool ContentType_t::isClean(const std::string &value) const {
+    // nothing to escape at all
+    if (escapes.empty()) return true;
+
+    // find first character having escape sequence
+    for (std::string::const_iterator ivalue = value.begin();
+         ivalue != value.end(); ++ivalue) {
+        if (escapeBitmap[static_cast<unsigned char>(*ivalue)] >= 0)
+            return false;
+    }
+    return true;
+}
+
 std::string ContentType_t::unescape(const std::string &src) const {
+    // nothing to unescape
+    if (unescapeStart == -1) return src;
+
     // output string
     std::string dest;
     dest.reserve(src.length());
 
     // run through input string
-    for (std::string::const_iterator isrc = src.begin();
-         isrc != src.end(); ) {
-        // help iterator
-        std::string::const_iterator bsrc = isrc;
+    const char *isrc = src.data();
+    const char *esrc = isrc + src.length();
+    while (isrc != esrc) {
+        // skip run of characters which cannot start escape sequence
+        const char *bsrc = isrc;
+        if (unescapeStart >= 0) {
+            bsrc = static_cast<const char*>
+                (memchr(isrc, unescapeStart, esrc - isrc));
+            if (!bsrc) bsrc = esrc;
+        } else {
+            while ((bsrc != esrc)
+                   && !unescaper[static_cast<unsigned char>(*bsrc)])
+                ++bsrc;
+        }
+        // pass skipped characters verbatim to output
+        dest.append(isrc, bsrc);
+        if ((isrc = bsrc) == esrc) break;
+
         // index in automaton
         int state = 0;
         // run through remaining characters
-        for (; bsrc != src.end(); ++bsrc) {
+        for (; bsrc != esrc; ++bsrc) {
             // move to next state
-            state = nextState(*bsrc, state);
+            state = unescaper[(state << 8) + static_cast<unsigned char>(*bsrc)];
             // we stop here if state is not positive
             if (state <= 0) break;
         }
@@ -230,23 +260,6 @@ std::string ContentType_t::unescape(const std::string &src) const {
     return dest;
 }
 
-int ContentType_t::nextState(unsigned char c, int state) const {
-    // stop when state outside automaton
-    if ((static_cast<unsigned int>(state) >= unescaper.size()) ||
-        (state < 0)) return 0;
-
-    // iterator to state
-    std::vector<std::pair<int, int> >::const_iterator
-        i = unescaper.begin() + state;
-
-    // find rule to move to next state
-    for (; i->first > 0; ++i)
-        if (i->first == c)
-            return i->second;
-    // no rule => stop
-    return 0;
-}
-
 /**
  * @short State in unescaper automaton.
  */
@@ -299,37 +312,25 @@ struct UnescaperState_t {
     }
 
     /**
-     * @short Linearize automaton tree.
+     * @short Write automaton tree into dense transition table.
+     * @param unescaper transition table (256 entries per state)
+     * @return index of this state in the table
      */
-    void linearize(std::vector<std::pair<int, int> > &unescaper) const {
-        // remember link holders
-        std::vector<int> referrers;
+    int tabulate(std::vector<int> &unescaper) const {
+        // allocate row for this state
+        int state = unescaper.size() >> 8;
+        unescaper.resize(unescaper.size() + 256, 0);
         // run throgh next states and write rule for each
         for (UnescaperStateVector_t::const_iterator i = nextStates.begin();
              i != nextStates.end(); ++i) {
-            // remember position of link to next state
-            referrers.push_back(unescaper.size());
-            // create state
-            unescaper.push_back(std::pair<int, int>(i->rule, -i->nextState));
-        }
-        // put STOP indicator when we have any next state
-        if (nextState == 0)
-            unescaper.push_back(std::pair<int, int>(0, 0));
-        // run through all rules
-        std::vector<int>::const_iterator ireferrers = referrers.begin();
-        for (UnescaperStateVector_t::const_iterator i = nextStates.begin();
-             i != nextStates.end(); ++i, ++ireferrers) {
-            if (!i->nextState) {
-                // remember start of next state
-                int pos = unescaper.size();
-                // linearize this state
-                i->linearize(unescaper);
-                // assign link to sub state
-                unescaper[*ireferrers].second = pos;
-            }
+            // final state => negated character; otherwise link to
+            // tabulated sub state
+            int next = i->nextState ? -i->nextState : i->tabulate(unescaper);
+            unescaper[(state << 8) + static_cast<unsigned char>(i->rule)]
+                = next;
         }
+        return state;
     }
-
 };
 
 void ContentType_t::compileUnescaper() {
@@ -356,8 +357,17 @@ void ContentType_t::compileUnescaper() {
         // assign unescaped character as final rule
         state->nextState = iescapes->first;
     }
-    // linearize automaton into vector
-    root.linearize(unescaper);
+    // write automaton into transition table
+    root.tabulate(unescaper);
+
+    // find characters starting escape sequences
+    unescapeStart = -1;
+    for (int c = 0; c < 256; ++c) {
+        if (unescaper[c]) {
+            unescapeStart = (unescapeStart == -1) ? c : -2;
+            if (unescapeStart == -2) break;
+        }
+    }
 }
 
 /** @short Create descriptor of HTML/XHTML/XML content type.
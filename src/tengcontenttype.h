@@ -91,6 +91,13 @@ public:
      */
     virtual std::string escape(const std::string &src) const;
 
+    /** @short Check whether given string passes escaping unchanged.
+     *
+     * @param value value to check
+     * @return true when escape(value) == value
+     */
+    bool isClean(const std::string &value) const;
+
     /** @short Unescape given string.
      * @param src string to unescape
      * @return unescaped string
@@ -154,17 +161,17 @@ private:
     int escapeBitmap[256];
 
     /**
-     * @short Unescaping automaton.
+     * @short Unescaping automaton: dense transition table with 256
+     *        entries per state. Each entry holds +state or -character
+     *        or 0 (on no match). State 0 is the start state.
      */
-    std::vector<std::pair<int, int> > unescaper;
+    std::vector<int> unescaper;
 
     /**
-     * @short Moves to next state of automaton.
-     * @param c characted being matched
-     * @param state current state
-     * @return new +state or -character or 0 (on no match)
+     * @short The only character starting escape sequences (-1 when
+     *        there are no escapes, -2 when there are more of them).
      */
-    int nextState(unsigned char c, int state) const;
+    int unescapeStart;
 };
 
 class Escaper_t {
@@ -214,6 +221,17 @@ public:
         return escapers.top()->escape(src);
     }
 
+    /** @short Check whether value needs no escaping.
+     *
+     * Uses escaper on the top of the stack.
+     *
+     * @param value value to check
+     * @return true when escaping would not change the value
+     */
+    inline bool isClean(const std::string &value) const {
+        return escapers.top()->isClean(value);
+    }
+
     /** @short Unescape given string.
      *
      * Uses escaper on the top of the stack.
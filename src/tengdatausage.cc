@@ -0,0 +1,68 @@
+/*
+ * Teng -- a general purpose templating engine.
+ * Copyright (C) 2004  Seznam.cz, a.s.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Seznam.cz, a.s.
+ * Naskove 1, Praha 5, 15000, Czech Republic
+ * http://www.seznam.cz, mailto:teng@firma.seznam.cz
+ *
+ *
+ *
+ * $Id: $
+ *
+ * DESCRIPTION
+ * Set of data paths (variables and fragments) a program can access.
+ */
+
+#include "tengdatausage.h"
+
+namespace Teng {
+
+void DataUsage_t::add(const std::string &path, unsigned int usage) {
+    paths[path] |= usage;
+}
+
+void DataUsage_t::clear() {
+    paths.clear();
+    everything = false;
+}
+
+bool DataUsage_t::isUsed(const std::string &path) const {
+    if (everything) return true;
+
+    // path itself
+    if (paths.find(path) != paths.end()) return true;
+
+    // any path below (all of them are prefixed with "path.")
+    std::string prefix(path + '.');
+    Paths_t::const_iterator i = paths.lower_bound(prefix);
+    if ((i != paths.end()) && !i->first.compare(0, prefix.length(), prefix))
+        return true;
+
+    // any path above accessed dynamically
+    for (std::string::size_type dot = path.rfind('.');
+         dot != std::string::npos;
+         dot = dot ? path.rfind('.', dot - 1) : std::string::npos) {
+        Paths_t::const_iterator p = paths.find(path.substr(0, dot));
+        if ((p != paths.end()) && (p->second & US_SUBTREE)) return true;
+    }
+
+    // not used
+    return false;
+}
+
+} // namespace Teng
@@ -0,0 +1,128 @@
+/*
+ * Teng -- a general purpose templating engine.
+ * Copyright (C) 2004  Seznam.cz, a.s.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Seznam.cz, a.s.
+ * Naskove 1, Praha 5, 15000, Czech Republic
+ * http://www.seznam.cz, mailto:teng@firma.seznam.cz
+ *
+ *
+ *
+ * $Id: $
+ *
+ * DESCRIPTION
+ * Set of data paths (variables and fragments) a program can access.
+ */
+
+#ifndef TENGDATAUSAGE_H
+#define TENGDATAUSAGE_H
+
+#include <string>
+#include <map>
+
+namespace Teng {
+
+/**
+ * @short Data paths the program can possibly access.
+ *
+ * Paths are fully qualified names as written in templates (e.g.
+ * ".row.name"); root fragment is "". Computed statically from
+ * compiled program, so it is superset of what the program really
+ * reads for any data.
+ */
+class DataUsage_t {
+public:
+    /**
+     * @short Kinds of access to path.
+     */
+    enum Usage_t {
+        US_VARIABLE = 0x01, //!< value read
+        US_FRAGMENT = 0x02, //!< fragment entered or counted
+        US_EXIST    = 0x04, //!< existence tested
+        US_SUBTREE  = 0x08  //!< anything below may be read (dynamic access)
+    };
+
+    /**
+     * @short Map of paths to bitmask of usages.
+     */
+    typedef std::map<std::string, unsigned int> Paths_t;
+
+    /**
+     * @short Create empty usage.
+     */
+    DataUsage_t()
+        : paths(), everything(false)
+    {}
+
+    /**
+     * @short Record access to path.
+     * @param path fully qualified path
+     * @param usage bitmask of Usage_t
+     */
+    void add(const std::string &path, unsigned int usage);
+
+    /**
+     * @short Record that whole data tree can be read (e.g. debug dump).
+     */
+    inline void addEverything() {
+        everything = true;
+    }
+
+    /**
+     * @short Forget all recorded paths.
+     */
+    void clear();
+
+    /**
+     * @short Tell whether data at path may be needed by program.
+     *
+     * True when path itself, any path below it or any path above it
+     * with US_SUBTREE usage has been recorded.
+     *
+     * @param path fully qualified path
+     */
+    bool isUsed(const std::string &path) const;
+
+    /**
+     * @short Tell whether whole data tree can be read.
+     */
+    inline bool isEverythingUsed() const {
+        return everything;
+    }
+
+    /**
+     * @short Recorded paths.
+     */
+    inline const Paths_t& getPaths() const {
+        return paths;
+    }
+
+private:
+    /**
+     * @short Recorded paths.
+     */
+    Paths_t paths;
+
+    /**
+     * @short Whole data tree can be read.
+     */
+    bool everything;
+};
+
+} // namespace Teng
+
+#endif // TENGDATAUSAGE_H
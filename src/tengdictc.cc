@@ -0,0 +1,101 @@
+/*
+ * Teng -- a general purpose templating engine.
+ * Copyright (C) 2004  Seznam.cz, a.s.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Seznam.cz, a.s.
+ * Naskove 1, Praha 5, 15000, Czech Republic
+ * http://www.seznam.cz, mailto:teng@firma.seznam.cz
+ *
+ *
+ * $Id: $
+ *
+ * DESCRIPTION
+ * Compiler of dictionaries and configurations into binary images
+ * loadable (via mmap) by Dictionary_t.
+ *
+ * Usage: tengdictc [-c] <input> <output>
+ *     -c  input is configuration
+ *
+ * Relative paths (including %include directives) are relative to
+ * current working directory.
+ *
+ * Output is written into temporary file which is then renamed, so
+ * processes still mapping the old image are not affected.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include <string>
+
+#include "tengdictionary.h"
+#include "tengconfiguration.h"
+#include "tengfilesystem.h"
+
+int main(int argc, char *argv[]) {
+    // parse arguments
+    bool config = (argc == 4) && !strcmp(argv[1], "-c");
+    if ((argc != 3) && !config) {
+        std::cerr << "Usage: " << argv[0] << " [-c] <input> <output>"
+                  << std::endl;
+        return 2;
+    }
+    std::string input(argv[argc - 2]);
+    std::string output(argv[argc - 1]);
+
+    // relative paths are relative to current directory
+    char cwd[4096];
+    if (!getcwd(cwd, sizeof(cwd))) {
+        perror("getcwd");
+        return 1;
+    }
+
+    // parse source
+    Teng::Filesystem_t filesystem;
+    Teng::Dictionary_t *dict = config
+        ? new Teng::Configuration_t(cwd)
+        : new Teng::Dictionary_t(cwd);
+    int ret = dict->parse(&filesystem, input);
+    dict->getErrors().dump(std::cerr);
+
+    // create image
+    std::string image;
+    dict->compile(image);
+    delete dict;
+    if (ret) return 1;
+
+    // write it into temporary file and move it into place
+    std::string tmp = output + ".tmp";
+    FILE *fp = fopen(tmp.c_str(), "wb");
+    if (!fp) {
+        perror(tmp.c_str());
+        return 1;
+    }
+    if ((fwrite(image.data(), 1, image.size(), fp) != image.size())
+        || fclose(fp)) {
+        perror(tmp.c_str());
+        unlink(tmp.c_str());
+        return 1;
+    }
+    if (rename(tmp.c_str(), output.c_str())) {
+        perror(output.c_str());
+        unlink(tmp.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -39,6 +39,8 @@
 
 #include <iostream>
 #include <utility>
+#include <memory>
+#include <string.h>
 #include <ctype.h>
 #include <errno.h>
 
@@ -46,6 +48,7 @@
 #include "tengfilesystem.h"
 #include "tengplatform.h"
 #include "tengaux.h"
+#include "tengcache.h"
 
 namespace Teng {
 
@@ -54,10 +57,16 @@ int Dictionary_t::parse(const FilesystemInterface_t *filesystem,
 {
     level = MAX_RECURSION_LEVEL;
     Error_t::Position_t pos(filename);
-    return parse(filesystem, filename, pos);
+    int ret = parse(filesystem, filename, pos);
+    // dictionary is complete => make lookups fast
+    freeze();
+    return ret;
 }
 
 Dictionary_t::~Dictionary_t() {
+    // release shared base
+    if (base) includeCache->release(base);
+    delete mapped;
 }
 
 namespace {
@@ -243,9 +252,12 @@ int Dictionary_t::parseIdentLine(const std::string &line,
 }
 
 int Dictionary_t::add(const std::string &name, const std::string &value) {
+    // frozen dictionary cannot be modified
+    if (isFrozen()) thaw();
     if (replaceValue) {
         dict[name] = value;
-    } else {
+    } else if (!(base && base->lookupEntry(name))) {
+        // entries from base are not replaced either
         dict.insert(std::make_pair(name, value));
     }
     return 0;
@@ -306,14 +318,140 @@ int Dictionary_t::add(const std::string &name, const std::string &value,
     return add(name, value);
 }
 
+namespace {
+    /**
+     * @short Identification of binary image of dictionary.
+     */
+    const char BINARY_MAGIC[8] = { 'T', 'E', 'N', 'G', 'D', 'I', 'C', 'T' };
+
+    /**
+     * @short Version of binary image of dictionary.
+     */
+    const unsigned int BINARY_VERSION = 1;
+
+    /**
+     * @short Computes FNV-1a hash of the key.
+     * @param data start of key
+     * @param length length of key
+     * @return hash value
+     */
+    inline unsigned int hashKey(const char *data, std::string::size_type length)
+    {
+        unsigned int hash = 2166136261u;
+        for (const char *end = data + length; data != end; ++data) {
+            hash ^= static_cast<unsigned char>(*data);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+}
+
 const std::string *Dictionary_t::lookup(const std::string &key) const {
-    // try to find key
-    std::map<std::string, std::string>::const_iterator f = dict.find(key);
+    const std::string *value = lookupEntry(key);
     // not found => null
-    if (f == dict.end())
+    if (!value)
         return key == "_tld"? &get_tld(): 0x0;
     // return value
-    return &f->second;
+    return value;
+}
+
+const std::string *Dictionary_t::lookupEntry(const std::string &key) const {
+    const std::string *value = 0;
+    if (isFrozen()) {
+        // search frozen dictionary
+        value = find(key);
+    } else {
+        // try to find key
+        std::map<std::string, std::string>::const_iterator f = dict.find(key);
+        if (f != dict.end()) value = &f->second;
+    }
+    // not found => try base
+    if (!value && base) return base->lookupEntry(key);
+    // return value
+    return value;
+}
+
+const std::string *Dictionary_t::find(const std::string &key) const {
+    // binary image or own table
+    const Entry_t *slots = mapped ? mappedTable : &table[0];
+    const char *keyData = mapped ? mappedBlob : keys.data();
+    unsigned int mask = (mapped ? mappedTableSize : table.size()) - 1;
+
+    unsigned int hash = hashKey(key.data(), key.length());
+    // linear probing until empty slot
+    for (unsigned int i = hash & mask; ; i = (i + 1) & mask) {
+        const Entry_t &entry = slots[i];
+        if (!entry.value) return 0;
+        if ((entry.hash == hash) && (entry.keyLength == key.length())
+            && !memcmp(keyData + entry.keyOffset, key.data(),
+                       entry.keyLength))
+            return &values[entry.value - 1];
+    }
+}
+
+void Dictionary_t::freeze() {
+    // nothing new to freeze
+    if (dict.empty()) return;
+    if (isFrozen()) thaw();
+
+    // table at most half full
+    unsigned int size = 2;
+    while (size < (2 * dict.size())) size <<= 1;
+
+    // prepare storage
+    Entry_t empty = { 0, 0, 0, 0 };
+    table.assign(size, empty);
+    values.reserve(dict.size());
+    std::string::size_type keysLength = 0;
+    for (std::map<std::string, std::string>::const_iterator
+             idict = dict.begin(); idict != dict.end(); ++idict)
+        keysLength += idict->first.length();
+    keys.reserve(keysLength);
+
+    // move entries into the table
+    for (std::map<std::string, std::string>::const_iterator
+             idict = dict.begin(); idict != dict.end(); ++idict) {
+        const std::string &key = idict->first;
+        Entry_t entry;
+        entry.hash = hashKey(key.data(), key.length());
+        entry.keyOffset = keys.length();
+        entry.keyLength = key.length();
+        entry.value = values.size() + 1;
+        keys.append(key);
+        values.push_back(idict->second);
+
+        // find free slot
+        unsigned int i = entry.hash & (size - 1);
+        while (table[i].value) i = (i + 1) & (size - 1);
+        table[i] = entry;
+    }
+
+    // parsing map is not needed any more
+    std::map<std::string, std::string>().swap(dict);
+}
+
+void Dictionary_t::thaw() {
+    // binary image or own table
+    const Entry_t *slots = mapped ? mappedTable : &table[0];
+    const char *keyData = mapped ? mappedBlob : keys.data();
+    unsigned int size = mapped ? mappedTableSize : table.size();
+
+    for (unsigned int i = 0; i < size; ++i) {
+        if (slots[i].value)
+            dict.insert(std::make_pair(std::string(keyData + slots[i].keyOffset,
+                                                   slots[i].keyLength),
+                                       values[slots[i].value - 1]));
+    }
+    std::vector<Entry_t>().swap(table);
+    std::vector<std::string>().swap(values);
+    std::string().swap(keys);
+
+    // release binary image
+    delete mapped;
+    mapped = 0;
+    mappedTable = 0;
+    mappedTableSize = 0;
+    mappedBlob = 0;
 }
 
 int Dictionary_t::parseString(const FilesystemInterface_t *filesystem,
@@ -351,13 +489,16 @@ int Dictionary_t::parseString(const FilesystemInterface_t *filesystem,
                 }
                 // split directive to name and value
                 std::string::size_type sep = line.find_first_of(" \t\v", 1);
-                if (processDirective(filesystem,
-                                     line.substr(1, ((sep == std::string::npos)
-                                                     ? sep : (sep - 1))),
-                                     ((sep == std::string::npos)
-                                      ? std::string()
-                                      : line.substr(sep + 1)), pos))
+                std::string name(line.substr(1, ((sep == std::string::npos)
+                                                 ? sep : (sep - 1))));
+                std::string param((sep == std::string::npos)
+                                  ? std::string() : line.substr(sep + 1));
+                if (processDirective(filesystem, name, param, pos))
                     ret = -1;
+                else if ((name != "include") && (name != "expand")
+                         && (name != "replace"))
+                    // remember directive for binary image
+                    directives.push_back(std::make_pair(name, param));
             } else if (isspace(first)) {
                 // append to previous line
                 if (currentValid) {
@@ -429,7 +570,15 @@ int Dictionary_t::parse(const FilesystemInterface_t *filesystem,
 
     try {
         Error_t::Position_t newPos(filename, 1);
-        return parseString(filesystem, filesystem->read(filename), newPos);
+        std::auto_ptr<MappedFile_t> file
+            (filesystem->map(filename, std::string(BINARY_MAGIC,
+                                                   sizeof(BINARY_MAGIC))));
+        // binary image starts with magic (text sources are read)
+        if ((file->size >= sizeof(BINARY_MAGIC))
+            && !memcmp(file->data, BINARY_MAGIC, sizeof(BINARY_MAGIC)))
+            return load(filesystem, file.release(), newPos);
+        return parseString(filesystem, std::string(file->data, file->size),
+                           newPos);
     }
     catch (const std::exception &e) {
         err.logSyscallError(Error_t::LL_ERROR, pos, e.what());
@@ -471,8 +620,13 @@ int Dictionary_t::processDirective(const FilesystemInterface_t *filesystem,
         }
         // decrement recursion level
         --level;
-        // parse given file
-        int ret = parse(filesystem, filename, pos);
+        // first include of the top level file with no entries so
+        // far and default flags can be shared with other dictionaries
+        int ret = (includeCache && !base && dict.empty() && table.empty()
+                   && (level == (MAX_RECURSION_LEVEL - 1))
+                   && !expandValue && !replaceValue)
+            ? includeBase(filesystem, filename, pos)
+            : parse(filesystem, filename, pos);
         // indecrement recursion level
         ++level;
         return ret;
@@ -507,13 +661,243 @@ int Dictionary_t::processDirective(const FilesystemInterface_t *filesystem,
     return -1;
 }
 
+int Dictionary_t::includeBase(const FilesystemInterface_t *filesystem,
+                              const std::string &filename,
+                              Error_t::Position_t &pos)
+{
+    // find included dictionary in the cache
+    Key_t key;
+    tengCreateKey(root, filename, key);
+    unsigned long int dependSerial = 0;
+    const Dictionary_t *included = includeCache->find(key, dependSerial);
+    if (included && included->check()) {
+        // changed => parse it again
+        includeCache->release(included);
+        included = 0;
+    }
+
+    if (!included) {
+        // not found or changed -> parse included file on its own
+        Dictionary_t *dictionary = new Dictionary_t(root);
+        dictionary->level = level;
+        dictionary->parse(filesystem, filename, pos);
+        dictionary->freeze();
+        // add dictionary to cache (we own one reference)
+        included = includeCache->add(key, dictionary);
+    }
+    base = included;
+
+    // take sources, errors and final flags of the included file
+    sources.append(base->sources);
+    err.append(base->err);
+    expandValue = base->expandValue;
+    replaceValue = base->replaceValue;
+
+    return base->err ? -1 : 0;
+}
+
+void Dictionary_t::collect(std::map<std::string, const std::string*> &records)
+    const
+{
+    if (isFrozen()) {
+        // binary image or own table
+        const Entry_t *slots = mapped ? mappedTable : &table[0];
+        const char *keyData = mapped ? mappedBlob : keys.data();
+        unsigned int size = mapped ? mappedTableSize : table.size();
+        for (unsigned int i = 0; i < size; ++i) {
+            if (slots[i].value)
+                records.insert(std::make_pair(
+                    std::string(keyData + slots[i].keyOffset,
+                                slots[i].keyLength),
+                    &values[slots[i].value - 1]));
+        }
+    }
+    for (std::map<std::string, std::string>::const_iterator i = dict.begin();
+         i != dict.end(); ++i)
+        records.insert(std::make_pair(i->first, &i->second));
+    // entries from base (own entries take precedence)
+    if (base) base->collect(records);
+}
+
+int Dictionary_t::load(const FilesystemInterface_t *filesystem,
+                       MappedFile_t *file, Error_t::Position_t &pos)
+{
+    std::auto_ptr<MappedFile_t> image(file);
+
+    // check header
+    Header_t header;
+    if (image->size < sizeof(header)) {
+        err.logError(Error_t::LL_ERROR, pos, "Truncated binary dictionary");
+        return -1;
+    }
+    memcpy(&header, image->data, sizeof(header));
+    if (header.version != BINARY_VERSION) {
+        err.logError(Error_t::LL_ERROR, pos,
+                     "Unsupported version of binary dictionary");
+        return -1;
+    }
+
+    // check sizes of all parts
+    std::string::size_type tableBytes
+        = std::string::size_type(header.tableSize) * sizeof(Entry_t);
+    std::string::size_type stringsBytes
+        = (std::string::size_type(header.valueCount)
+           + 2 * std::string::size_type(header.directiveCount))
+        * sizeof(String_t);
+    if ((header.tableSize < 2) || (header.tableSize & (header.tableSize - 1))
+        || (header.valueCount >= header.tableSize)
+        || ((sizeof(header) + tableBytes + stringsBytes + header.blobSize)
+            != image->size)) {
+        err.logError(Error_t::LL_ERROR, pos, "Corrupted binary dictionary");
+        return -1;
+    }
+    const char *data = image->data + sizeof(header);
+    const Entry_t *slots = reinterpret_cast<const Entry_t*>(data);
+    const String_t *strings
+        = reinterpret_cast<const String_t*>(data + tableBytes);
+    const char *blob = data + tableBytes + stringsBytes;
+
+    // check all references (there must be some free slot)
+    unsigned int used = 0;
+    for (unsigned int i = 0; i < header.tableSize; ++i) {
+        if (!slots[i].value) continue;
+        if ((slots[i].value > header.valueCount)
+            || (slots[i].keyOffset > header.blobSize)
+            || (slots[i].keyLength > header.blobSize - slots[i].keyOffset)
+            || (++used >= header.tableSize)) {
+            err.logError(Error_t::LL_ERROR, pos,
+                         "Corrupted binary dictionary");
+            return -1;
+        }
+    }
+    for (unsigned int i = 0;
+         i < header.valueCount + 2 * header.directiveCount; ++i) {
+        if ((strings[i].offset > header.blobSize)
+            || (strings[i].length > header.blobSize - strings[i].offset)) {
+            err.logError(Error_t::LL_ERROR, pos,
+                         "Corrupted binary dictionary");
+            return -1;
+        }
+    }
+
+    if (!isFrozen() && !base && dict.empty()) {
+        // nothing defined so far => use image as is
+        mapped = image.release();
+        mappedTable = slots;
+        mappedTableSize = header.tableSize;
+        mappedBlob = blob;
+        // values are materialized now, so lookup() never writes
+        values.resize(header.valueCount);
+        for (unsigned int i = 0; i < header.valueCount; ++i)
+            values[i].assign(blob + strings[i].offset, strings[i].length);
+    } else {
+        // merge image into this dictionary
+        for (unsigned int i = 0; i < header.tableSize; ++i) {
+            if (slots[i].value) {
+                const String_t &value = strings[slots[i].value - 1];
+                add(std::string(blob + slots[i].keyOffset, slots[i].keyLength),
+                    std::string(blob + value.offset, value.length));
+            }
+        }
+    }
+
+    // replay processing directives
+    int ret = 0;
+    const String_t *idirectives = strings + header.valueCount;
+    for (unsigned int i = 0; i < header.directiveCount; ++i) {
+        std::string name(blob + idirectives[2 * i].offset,
+                         idirectives[2 * i].length);
+        std::string param(blob + idirectives[2 * i + 1].offset,
+                          idirectives[2 * i + 1].length);
+        if (processDirective(filesystem, name, param, pos)) ret = -1;
+        else directives.push_back(std::make_pair(name, param));
+    }
+    return ret;
+}
+
+int Dictionary_t::compile(std::string &out) const {
+    // collect all records sorted by key
+    std::map<std::string, const std::string*> records;
+    collect(records);
+
+    // table at most half full
+    unsigned int size = 2;
+    while (size < (2 * records.size())) size <<= 1;
+
+    // build table, values and blob
+    Entry_t empty = { 0, 0, 0, 0 };
+    std::vector<Entry_t> slots(size, empty);
+    std::vector<String_t> strings;
+    strings.reserve(records.size() + 2 * directives.size());
+    std::string blob;
+    for (std::map<std::string, const std::string*>::const_iterator
+             irecords = records.begin(); irecords != records.end();
+         ++irecords) {
+        const std::string &key = irecords->first;
+        Entry_t entry;
+        entry.hash = hashKey(key.data(), key.length());
+        entry.keyOffset = blob.length();
+        entry.keyLength = key.length();
+        entry.value = strings.size() + 1;
+        blob.append(key);
+        String_t value;
+        value.offset = blob.length();
+        value.length = irecords->second->length();
+        blob.append(*irecords->second);
+        strings.push_back(value);
+
+        // find free slot
+        unsigned int i = entry.hash & (size - 1);
+        while (slots[i].value) i = (i + 1) & (size - 1);
+        slots[i] = entry;
+    }
+    for (std::vector<std::pair<std::string, std::string> >::const_iterator
+             idirectives = directives.begin();
+         idirectives != directives.end(); ++idirectives) {
+        String_t name;
+        name.offset = blob.length();
+        name.length = idirectives->first.length();
+        blob.append(idirectives->first);
+        String_t param;
+        param.offset = blob.length();
+        param.length = idirectives->second.length();
+        blob.append(idirectives->second);
+        strings.push_back(name);
+        strings.push_back(param);
+    }
+
+    // header
+    Header_t header;
+    memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.version = BINARY_VERSION;
+    header.tableSize = size;
+    header.valueCount = records.size();
+    header.directiveCount = directives.size();
+    header.blobSize = blob.length();
+
+    // write image
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(reinterpret_cast<const char*>(&slots[0]),
+               slots.size() * sizeof(Entry_t));
+    if (!strings.empty())
+        out.append(reinterpret_cast<const char*>(&strings[0]),
+                   strings.size() * sizeof(String_t));
+    out.append(blob);
+    // OK
+    return 0;
+}
+
 int Dictionary_t::dump(std::string &out) const {
+    // collect all records sorted by key
+    std::map<std::string, const std::string*> records;
+    collect(records);
+
     // dumm all records
-    for (std::map<std::string, std::string>::const_iterator i = dict.begin();
-         i != dict.end(); ++i) {
+    for (std::map<std::string, const std::string*>::const_iterator
+             i = records.begin(); i != records.end(); ++i) {
         out.append(i->first);
         out.append(": |");
-        out.append(i->second);
+        out.append(*i->second);
         out.append("|\n----------------------------------------\n");
     }
     // OK
@@ -41,6 +41,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <utility>
 
 #include "tengerror.h"
 #include "tengsourcelist.h"
@@ -48,6 +49,9 @@
 namespace Teng {
 
 class FilesystemInterface_t;
+class MappedFile_t;
+
+template <typename DataType_t> class Cache_t;
 
 /**
  * @short Dictionary -- mapping of string to string value.
@@ -60,10 +64,16 @@ public:
      * @short Creates new dictionary object.
      *
      * @param root path of root for locating files
+     * @param includeCache cache of included dictionaries shared
+     *        with other dictionaries (0 = no sharing)
      */
-    Dictionary_t(const std::string &root)
-        : root(root), level(0), sources(), err(), expandValue(false),
-        replaceValue(false)
+    Dictionary_t(const std::string &root,
+                 Cache_t<Dictionary_t> *includeCache = 0)
+        : root(root), level(0), sources(), err(), directives(), dict(),
+          keys(), values(), table(), mapped(0), mappedTable(0),
+          mappedTableSize(0), mappedBlob(0), base(0),
+          includeCache(includeCache),
+          expandValue(false), replaceValue(false)
     {}
 
     /**
@@ -73,6 +83,10 @@ public:
 
     /**
      * @short Parses dicionary from given file.
+     *        Dictionary is frozen (see freeze()) after parsing.
+     *
+     * File can be either text dictionary or binary image created by
+     * compile(). Binary image is mapped into memory and used as is.
      *
      * @param filename name of file to parse
      * @return 0 OK !0 error
@@ -80,6 +94,26 @@ public:
     int parse(const FilesystemInterface_t *filesystem,
               const std::string &filename);
 
+    /**
+     * @short Moves entries from the parsing map into the compact
+     *        lookup table.
+     *
+     * Entries added later are moved back to the map first (which is
+     * slow), so dictionary should be frozen when it is complete.
+     */
+    void freeze();
+
+    /**
+     * @short Creates binary image of the dictionary.
+     *
+     * Image contains hashed index of keys, values and processing
+     * directives (replayed when loaded) in native byte order.
+     *
+     * @param out output string
+     * @return 0 OK !0 error
+     */
+    int compile(std::string &out) const;
+
     /**
      * @short Adds new entry into dictionary. Doesn't replace
      *        existing entry.
@@ -231,6 +265,12 @@ protected:
      */
     Error_t err;
 
+    /**
+     * @short Processing directives (other than include, expand and
+     *        replace) in order of appearance. Stored in binary image.
+     */
+    std::vector<std::pair<std::string, std::string> > directives;
+
 private:
     /**
      * @short Copy constructor intentionally private -- copying
@@ -245,10 +285,148 @@ private:
     Dictionary_t operator=(const Dictionary_t&);
 
     /**
-     * @short The dictionary itself.
+     * @short Moves entries from the lookup table back to the map.
+     */
+    void thaw();
+
+    /**
+     * @short Loads binary image of dictionary.
+     *
+     * @param file binary image (stolen)
+     * @param pos position in current file
+     * @return 0 OK !0 error
+     */
+    int load(const FilesystemInterface_t *filesystem, MappedFile_t *file,
+             Error_t::Position_t &pos);
+
+    /**
+     * @short Includes given file as shared base dictionary.
+     *
+     * Base is taken from (or parsed into) the include cache.
+     *
+     * @param filename name of included file
+     * @param pos position in current file
+     * @return 0 OK !0 error
+     */
+    int includeBase(const FilesystemInterface_t *filesystem,
+                    const std::string &filename,
+                    Error_t::Position_t &pos);
+
+    /**
+     * @short Searches for key in this dictionary and its base.
+     * @param key the key
+     * @return found value or 0 when key not found
+     */
+    const std::string* lookupEntry(const std::string &key) const;
+
+    /**
+     * @short Entry of the frozen dictionary.
+     */
+    struct Entry_t {
+        unsigned int hash;      //!< hash of key
+        unsigned int keyOffset; //!< offset of key in keys
+        unsigned int keyLength; //!< length of key
+        unsigned int value;     //!< index of value in values + 1 (0 = empty)
+    };
+
+    /**
+     * @short Searches for key in the frozen dictionary.
+     * @param key the key
+     * @return found value or 0 when key not found
+     */
+    const std::string* find(const std::string &key) const;
+
+    /**
+     * @short Collects all entries (including base).
+     * @param records output mapping (existing entries are kept)
+     */
+    void collect(std::map<std::string, const std::string*> &records) const;
+
+    /**
+     * @short Tells whether dictionary is frozen.
+     * @return true when frozen
+     */
+    bool isFrozen() const {
+        return mapped || !table.empty();
+    }
+
+    /**
+     * @short Reference to string in binary image.
+     */
+    struct String_t {
+        unsigned int offset; //!< offset in blob
+        unsigned int length; //!< length of string
+    };
+
+    /**
+     * @short Header of binary image.
+     *
+     * Header is followed by table (Entry_t), values (String_t),
+     * directives (pairs of String_t) and blob of all strings.
+     */
+    struct Header_t {
+        char magic[8];               //!< identification of format
+        unsigned int version;        //!< version of format
+        unsigned int tableSize;      //!< number of slots in table
+        unsigned int valueCount;     //!< number of values
+        unsigned int directiveCount; //!< number of directives
+        unsigned int blobSize;       //!< size of blob
+    };
+
+    /**
+     * @short The dictionary itself, used when parsing.
      */
     std::map<std::string, std::string> dict;
 
+    /**
+     * @short All keys of the frozen dictionary stored contiguously.
+     */
+    std::string keys;
+
+    /**
+     * @short Values of the frozen dictionary (values of binary image
+     *        are copied when image is loaded, so that lookup() needs
+     *        no locking; it's about 25 ns per value).
+     */
+    std::vector<std::string> values;
+
+    /**
+     * @short Open addressing hash table of the frozen dictionary
+     *        (size is power of 2, linear probing).
+     */
+    std::vector<Entry_t> table;
+
+    /**
+     * @short Binary image used as frozen dictionary (or 0).
+     */
+    MappedFile_t *mapped;
+
+    /**
+     * @short Table of binary image (keys are offsets in blob).
+     */
+    const Entry_t *mappedTable;
+
+    /**
+     * @short Number of slots in table of binary image.
+     */
+    unsigned int mappedTableSize;
+
+    /**
+     * @short Blob of binary image.
+     */
+    const char *mappedBlob;
+
+    /**
+     * @short Shared dictionary of the first include (borrowed from
+     *        includeCache). Own entries take precedence.
+     */
+    const Dictionary_t *base;
+
+    /**
+     * @short Cache of included dictionaries.
+     */
+    Cache_t<Dictionary_t> *includeCache;
+
     /** @short Flags whether #{name} is expanded in values.
      *
      * Valid only during parse.
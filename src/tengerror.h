@@ -45,6 +45,7 @@
 #include <cstring>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 
 namespace Teng {
 
@@ -62,9 +63,16 @@ public:
 
     /** @short Creates new error logger. */
     Error_t()
-        : level(LL_DEBUGING), entries()
+        : level(LL_DEBUGING), minLevel(LL_DEBUGING), entries(), index(),
+          shared(), snapshot(0)
     {};
 
+    /** @short Releases shared logs. */
+    ~Error_t() {
+        clearShared();
+        release(snapshot);
+    }
+
     /** @short Holds position in file. */
     struct Position_t {
         /** @short Creates new position object.
@@ -152,6 +160,25 @@ public:
    /** Max level of messages (or LL_DEBUGING if no message) */
     Level_t level;
 
+    /** @short Sets minimal level of logged messages. Messages with
+      *        lower level are dropped.
+      * @param minLevel minimal level */
+    void setMinLevel(Level_t minLevel) {
+        this->minLevel = minLevel;
+    }
+
+    /** @short Returns minimal level of logged messages.
+      * @return minimal level */
+    Level_t getMinLevel() const {
+        return minLevel;
+    }
+
+    /** @short Tells whether messages of given level are logged.
+      * @return true if logged */
+    bool isLogged(Level_t level) const {
+        return level >= minLevel;
+    }
+
     /** @short Entry in error log. */
     struct Entry_t {
 
@@ -162,7 +189,8 @@ public:
           * @param message additional message  */
         Entry_t(Level_t level, const std::string &filename, int lineno,
                 int col, const std::string &message)
-            : level(level), pos(filename, lineno, col), message(message)
+            : level(level), pos(filename, lineno, col), message(message),
+              count(1), prefix(0), format(0), argument()
         {}
 
         /** @short Creates new entry.
@@ -170,7 +198,19 @@ public:
           * @param message column position in file */
         Entry_t(Level_t level, const Position_t &pos,
                 const std::string &message)
-            : level(level), pos(pos), message(message)
+            : level(level), pos(pos), message(message), count(1),
+              prefix(0), format(0), argument()
+        {}
+
+        /** @short Creates new entry with message formatted later.
+          * @param pos position in file
+          * @param prefix static prefix of message
+          * @param format static format of message (see logRuntimeError)
+          * @param argument argument of format */
+        Entry_t(Level_t level, const Position_t &pos, const char *prefix,
+                const char *format, const std::string &argument)
+            : level(level), pos(pos), message(), count(1),
+              prefix(prefix), format(format), argument(argument)
         {}
 
         /** @short Composes log line.
@@ -189,10 +229,14 @@ public:
             if (pos.lineno > 0 && pos.col >= 0)
                 out << "(" << pos.lineno << "," << pos.col << ")";
             out << " " << levelString[level];
-            // add message and EOL
-            out << ": " << message << std::endl;
+            // add message, repetition count and EOL
+            out << ": " << message;
+            if (count > 1)
+                out << " (" << count << " times)";
+            out << std::endl;
             return out.str();
         }
+
        /** @short Level of message. */
         Level_t level;
         
@@ -201,20 +245,55 @@ public:
         
         /** @short Additional message. */
         std::string message;
+
+        /** @short Number of occurrences of this message. */
+        unsigned int count;
+
+        /** @short Message not formatted yet: prefix, format and its
+          *        argument (format is 0 when message is final).
+          *        Messages are formatted when log is read. */
+        const char *prefix;
+        const char *format;
+        std::string argument;
     };
 
     /** @short Logs new error.
+      * Repeated error (same level, position and message) only
+      * increments count of the existing entry.
       * @param pos position in file
       * @param message additional message */
     void logError(Level_t level, const Position_t &pos,
                   const std::string &message) {
-        for(unsigned int i = 0; i < entries.size(); i++) {
-            if(entries[i].level == level && entries[i].pos.filename == pos.filename && entries[i].pos.lineno == pos.lineno && entries[i].pos.col == pos.col && entries[i].message == message) {
-                return;
-            }
-        }
-        entries.push_back(Entry_t(level, pos, message));
-        if (level > this->level) this->level = level;
+        if (level < minLevel) return;
+        touch();
+        unsigned int slot;
+        Entry_t *entry = findEntry(level, pos.filename, pos.lineno, pos.col,
+                                   Parts_t(message), slot);
+        if (entry) ++entry->count;
+        else insertEntry(Entry_t(level, pos, message), slot);
+    }
+
+    /** @short Logs runtime error with message formatted when the log
+      *        is read.
+      * The first "%s" in format is replaced by argument, no other
+      * formatting is done. Repeated error costs no allocation.
+      * @param filename associated file
+      * @param lineno line number
+      * @param col column position in file
+      * @param format message format (must be static string)
+      * @param argument argument of format */
+    void logRuntimeError(Level_t level, const std::string &filename,
+                         int lineno, int col, const char *format,
+                         const std::string &argument = std::string()) {
+        if (level < minLevel) return;
+        touch();
+        unsigned int slot;
+        Parts_t message(runtimePrefix(), format, argument);
+        Entry_t *entry = findEntry(level, filename, lineno, col, message,
+                                   slot);
+        if (entry) ++entry->count;
+        else insertEntry(Entry_t(level, Position_t(filename, lineno, col),
+                                 runtimePrefix(), format, argument), slot);
     }
 
     /** @short Log syscall error, no file associated. */
@@ -244,13 +323,17 @@ public:
       * @param message additional message */
     void logRuntimeError(Level_t level, const Position_t &pos,
                          const std::string &message) {
-        logError(level, pos, "Runtime: " + message);
+        logError(level, pos, runtimePrefix() + message);
     }
     
     /** @short Returns number of errors in log.
       * @return number of errors */
     int count() const {
-        return entries.size();
+        std::vector<Entry_t>::size_type result = entries.size();
+        for (std::vector<SharedRef_t>::const_iterator ishared = shared.begin();
+             ishared != shared.end(); ++ishared)
+            result += ishared->log->entries.size();
+        return result;
     }
     /** @short Returns level variable.
       */
@@ -260,33 +343,79 @@ public:
     /** @short Returns whether any error occurred.
       * @return true if any error occurred, false otherwise */
     operator bool() const {
-        return !entries.empty();
+        return !entries.empty() || !shared.empty();
     }
 
     /** @short Clears error log. */
     void clear() {
+        touch();
+        clearShared();
         entries.clear();
+        index.clear();
     }
 
     /** @short Appends content of another error log.
+      * Counts of entries already present are summed.
       * @param err appended log */
     void append(const Error_t &err) {
-        // increase level if lower than that of err
-        if (err.level > level) level = err.level;
-        // append error log
-        entries.insert(entries.end(), err.entries.begin(),
-                       err.entries.end());
+        touch();
+        err.materialize();
+        // append error log (messages stay unformatted)
+        for (std::vector<Entry_t>::const_iterator
+                 ientries = err.entries.begin();
+             ientries != err.entries.end(); ++ientries) {
+            if (ientries->level < minLevel) continue;
+            unsigned int slot;
+            Entry_t *entry = findEntry(ientries->level,
+                                       ientries->pos.filename,
+                                       ientries->pos.lineno,
+                                       ientries->pos.col,
+                                       parts(*ientries), slot);
+            if (entry) entry->count += ientries->count;
+            else insertEntry(*ientries, slot);
+        }
+    }
+
+    /** @short Appends content of another (rarely changing) error log
+      *        by reference.
+      * Entries are shared (refcounted snapshot of err made once per
+      * change of err) and copied only when this log is read by
+      * getEntries() or dump(). Shared entries are not merged with
+      * other entries.
+      * @param err appended log */
+    void appendShared(const Error_t &err) {
+        if (!err) return;
+        err.materialize();
+        Shared_t *log = err.getSnapshot();
+        // entries which would be dropped => copy the rest
+        if (log->minLevel < minLevel) {
+            append(err);
+            return;
+        }
+        // the same snapshot already shared
+        for (std::vector<SharedRef_t>::const_iterator ishared = shared.begin();
+             ishared != shared.end(); ++ishared)
+            if (ishared->log == log) return;
+        touch();
+        ++log->refCount;
+        SharedRef_t ref = { log, entries.size() };
+        shared.push_back(ref);
+        if (log->level > level) level = log->level;
     }
 
     /** @short Get raw error log.
       * @return error log */
     const std::vector<Entry_t>& getEntries() const {
+        materialize();
+        formatMessages();
         return entries;
     }
 
     /** @short Dumps log into stream.
       * @param out output stream */
     void dump(std::ostream &out) const {
+        materialize();
+        formatMessages();
         for (std::vector<Entry_t>::const_iterator
                  ientries = entries.begin();
              ientries != entries.end(); ++ientries) {
@@ -305,8 +434,278 @@ private:
      *         disabled. */
     Error_t operator=(const Error_t&);
 
-    /** @short Log of error entries. */
-    std::vector<Entry_t> entries;
+    /** @short Immutable refcounted copy of log entries. */
+    struct Shared_t {
+        std::vector<Entry_t> entries; //!< entries of log
+        Level_t level;                //!< max level of entries
+        Level_t minLevel;             //!< min level of entries
+        unsigned int refCount;        //!< number of owners
+    };
+
+    /** @short Shared log appended at given position. */
+    struct SharedRef_t {
+        Shared_t *log;                            //!< shared log
+        std::vector<Entry_t>::size_type position; //!< position in entries
+    };
+
+    /** @short Releases reference to shared log.
+      * @param log shared log (or 0) */
+    static void release(Shared_t *log) {
+        if (log && !--log->refCount) delete log;
+    }
+
+    /** @short Releases all shared logs. */
+    void clearShared() const {
+        for (std::vector<SharedRef_t>::const_iterator ishared = shared.begin();
+             ishared != shared.end(); ++ishared)
+            release(ishared->log);
+        shared.clear();
+    }
+
+    /** @short Invalidates snapshot of this log (log is changing). */
+    void touch() {
+        release(snapshot);
+        snapshot = 0;
+    }
+
+    /** @short Returns snapshot of entries (created when needed).
+      * @return snapshot */
+    Shared_t* getSnapshot() const {
+        if (!snapshot) {
+            snapshot = new Shared_t();
+            snapshot->entries = entries;
+            snapshot->level = LL_DEBUGING;
+            snapshot->minLevel = LL_FATAL;
+            for (std::vector<Entry_t>::const_iterator
+                     ientries = entries.begin();
+                 ientries != entries.end(); ++ientries) {
+                if (ientries->level > snapshot->level)
+                    snapshot->level = ientries->level;
+                if (ientries->level < snapshot->minLevel)
+                    snapshot->minLevel = ientries->level;
+            }
+            // owned by this log
+            snapshot->refCount = 1;
+        }
+        return snapshot;
+    }
+
+    /** @short Copies shared entries into entries (at positions where
+      *        they were appended). */
+    void materialize() const {
+        if (shared.empty()) return;
+        std::vector<Entry_t> result;
+        result.reserve(count());
+        std::vector<Entry_t>::size_type position = 0;
+        for (std::vector<SharedRef_t>::const_iterator ishared = shared.begin();
+             ishared != shared.end(); ++ishared) {
+            result.insert(result.end(), entries.begin() + position,
+                          entries.begin() + ishared->position);
+            position = ishared->position;
+            result.insert(result.end(), ishared->log->entries.begin(),
+                          ishared->log->entries.end());
+        }
+        result.insert(result.end(), entries.begin() + position,
+                      entries.end());
+        entries.swap(result);
+        clearShared();
+        // positions of entries changed (index is sized for all of them)
+        const_cast<Error_t*>(this)->rehash();
+    }
+
+    /** @short Prefix of runtime errors. */
+    static const char* runtimePrefix() {
+        return "Runtime: ";
+    }
+
+    /** @short Message split into parts (message is their
+      *        concatenation). */
+    struct Parts_t {
+        /** @short Creates parts of final message.
+          * @param message the message */
+        Parts_t(const std::string &message) {
+            set(0, message.data(), message.length());
+            set(1, 0, 0);
+            set(2, 0, 0);
+            set(3, 0, 0);
+        }
+
+        /** @short Creates parts of message to be formatted.
+          * @param prefix prefix of message
+          * @param format format of message
+          * @param argument argument of format */
+        Parts_t(const char *prefix, const char *format,
+                const std::string &argument) {
+            set(0, prefix, strlen(prefix));
+            const char *subst = strstr(format, "%s");
+            if (subst) {
+                set(1, format, subst - format);
+                set(2, argument.data(), argument.length());
+                set(3, subst + 2, strlen(subst + 2));
+            } else {
+                set(1, format, strlen(format));
+                set(2, 0, 0);
+                set(3, 0, 0);
+            }
+        }
+
+        /** @short Sets one part. */
+        void set(int i, const char *d, std::string::size_type s) {
+            data[i] = d;
+            size[i] = s;
+        }
+
+        /** @short Concatenates parts.
+          * @return message */
+        std::string str() const {
+            std::string result;
+            result.reserve(size[0] + size[1] + size[2] + size[3]);
+            for (int i = 0; i < 4; ++i) result.append(data[i], size[i]);
+            return result;
+        }
+
+        /** @short Compares messages (not parts).
+          * @param other other parts
+          * @return true if messages are same */
+        bool operator==(const Parts_t &other) const {
+            if ((size[0] + size[1] + size[2] + size[3])
+                != (other.size[0] + other.size[1] + other.size[2]
+                    + other.size[3]))
+                return false;
+            int i = 0, j = 0;
+            std::string::size_type oi = 0, oj = 0;
+            for (;;) {
+                // skip exhausted parts
+                while ((i < 4) && (oi == size[i])) { ++i; oi = 0; }
+                while ((j < 4) && (oj == other.size[j])) { ++j; oj = 0; }
+                if ((i == 4) || (j == 4)) return true;
+                // compare common chunk
+                std::string::size_type n = std::min(size[i] - oi,
+                                                    other.size[j] - oj);
+                if (memcmp(data[i] + oi, other.data[j] + oj, n))
+                    return false;
+                oi += n;
+                oj += n;
+            }
+        }
+
+        const char *data[4];              //!< data of parts
+        std::string::size_type size[4];   //!< sizes of parts
+    };
+
+    /** @short Returns parts of entry's message.
+      * @param entry log entry
+      * @return message parts */
+    static Parts_t parts(const Entry_t &entry) {
+        return entry.format
+            ? Parts_t(entry.prefix, entry.format, entry.argument)
+            : Parts_t(entry.message);
+    }
+
+    /** @short Computes hash of entry key (FNV-1a).
+      * @param filename associated file
+      * @param lineno line number
+      * @param col column position in file
+      * @param message message parts
+      * @return hash value */
+    static unsigned int hash(Level_t level, const std::string &filename,
+                             int lineno, int col, const Parts_t &message) {
+        unsigned int h = 2166136261u;
+        h = (h ^ level) * 16777619u;
+        h = (h ^ static_cast<unsigned int>(lineno)) * 16777619u;
+        h = (h ^ static_cast<unsigned int>(col)) * 16777619u;
+        for (std::string::const_iterator i = filename.begin();
+             i != filename.end(); ++i)
+            h = (h ^ static_cast<unsigned char>(*i)) * 16777619u;
+        for (int p = 0; p < 4; ++p) {
+            const char *end = message.data[p] + message.size[p];
+            for (const char *i = message.data[p]; i != end; ++i)
+                h = (h ^ static_cast<unsigned char>(*i)) * 16777619u;
+        }
+        return h;
+    }
+
+    /** @short Finds entry with given key.
+      * @param filename associated file
+      * @param lineno line number
+      * @param col column position in file
+      * @param message message parts
+      * @param slot free slot in index for new entry (output)
+      * @return found entry or 0 */
+    Entry_t* findEntry(Level_t level, const std::string &filename,
+                       int lineno, int col, const Parts_t &message,
+                       unsigned int &slot) {
+        // keep index at most half full
+        if (2 * (entries.size() + 1) > index.size()) rehash();
+
+        // search index (linear probing)
+        unsigned int mask = index.size() - 1;
+        unsigned int i = hash(level, filename, lineno, col, message) & mask;
+        for (; index[i]; i = (i + 1) & mask) {
+            Entry_t &entry = entries[index[i] - 1];
+            if ((entry.level == level) && (entry.pos.lineno == lineno)
+                && (entry.pos.col == col) && (entry.pos.filename == filename)
+                && (parts(entry) == message))
+                return &entry;
+        }
+        slot = i;
+        return 0;
+    }
+
+    /** @short Inserts new entry.
+      * @param entry new entry
+      * @param slot free slot in index (from findEntry) */
+    void insertEntry(const Entry_t &entry, unsigned int slot) {
+        entries.push_back(entry);
+        index[slot] = entries.size();
+        if (entry.level > level) level = entry.level;
+    }
+
+    /** @short Resizes index to be at most half full (with room for
+      *        next entry) and reinserts all entries. */
+    void rehash() {
+        unsigned int size = 16;
+        while (size < 2 * (entries.size() + 1)) size <<= 1;
+        index.assign(size, 0);
+        unsigned int mask = index.size() - 1;
+        for (unsigned int e = 0; e < entries.size(); ++e) {
+            const Entry_t &entry = entries[e];
+            unsigned int i = hash(entry.level, entry.pos.filename,
+                                  entry.pos.lineno, entry.pos.col,
+                                  parts(entry)) & mask;
+            while (index[i]) i = (i + 1) & mask;
+            index[i] = e + 1;
+        }
+    }
+
+    /** @short Formats messages of all entries. */
+    void formatMessages() const {
+        for (std::vector<Entry_t>::iterator ientries = entries.begin();
+             ientries != entries.end(); ++ientries) {
+            if (ientries->format) {
+                ientries->message = parts(*ientries).str();
+                ientries->prefix = 0;
+                ientries->format = 0;
+                std::string().swap(ientries->argument);
+            }
+        }
+    }
+
+    /** @short Minimal level of logged messages. */
+    Level_t minLevel;
+
+    /** @short Log of error entries (messages are formatted lazily). */
+    mutable std::vector<Entry_t> entries;
+
+    /** @short Hash index of entries (open addressing, size is power
+      *        of 2, values are entry index + 1, 0 = empty). */
+    mutable std::vector<unsigned int> index;
+
+    /** @short Logs appended by reference. */
+    mutable std::vector<SharedRef_t> shared;
+
+    /** @short Snapshot of this log shared by other logs (or 0). */
+    mutable Shared_t *snapshot;
 };
 
 } // namespace Teng
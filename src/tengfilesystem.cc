@@ -18,12 +18,104 @@
  */
 
 #include <stdio.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif //WIN32
+#include <stdexcept>
 
 #include "tengfilesystem.h"
 #include "tengutil.h"
 
 namespace Teng {
 
+namespace {
+
+/** @short File contents kept in string.
+ */
+class StringFile_t : public MappedFile_t {
+public:
+    StringFile_t(const std::string &contents)
+        : contents(contents)
+    {
+        data = this->contents.data();
+        size = this->contents.size();
+    }
+
+private:
+    std::string contents;
+};
+
+#ifndef WIN32
+/** @short File mapped by mmap(2).
+ */
+class MmapFile_t : public MappedFile_t {
+public:
+    MmapFile_t(void *address, std::string::size_type length) {
+        data = static_cast<const char*>(address);
+        size = length;
+    }
+
+    virtual ~MmapFile_t() {
+        munmap(const_cast<char*>(data), size);
+    }
+};
+#endif //WIN32
+
+} // namespace
+
+MappedFile_t* FilesystemInterface_t::map(const std::string &filename,
+                                         const std::string &) const
+{
+    return new StringFile_t(read(filename));
+}
+
+MappedFile_t* Filesystem_t::map(const std::string &filename_,
+                                const std::string &magic) const
+{
+#ifdef WIN32
+    // no mmap(2) => keep contents in memory
+    return FilesystemInterface_t::map(filename_, magic);
+#else //WIN32
+    std::string filename (filename_);
+    tengNormalizeFilename(filename);
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("open(" + filename + ")");
+
+    struct stat buf;
+    if (fstat(fd, &buf) < 0) {
+        close(fd);
+        throw std::runtime_error("fstat(" + filename + ")");
+    }
+
+    // empty file cannot be mapped
+    if (!buf.st_size) {
+        close(fd);
+        return new StringFile_t(std::string());
+    }
+
+    // map only files starting with magic, read anything else
+    std::string head(magic.length(), '\0');
+    if (!magic.empty()
+        && ((buf.st_size < off_t(magic.length()))
+            || (::read(fd, &head[0], head.length())
+                != ssize_t(head.length()))
+            || (head != magic))) {
+        close(fd);
+        return new StringFile_t(read(filename));
+    }
+
+    void *address = mmap(0, buf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    // fallback to plain read
+    if (address == MAP_FAILED) return new StringFile_t(read(filename));
+    return new MmapFile_t(address, buf.st_size);
+#endif //WIN32
+}
+
 std::string Filesystem_t::read(const std::string &filename_) const
 {
     std::string result;
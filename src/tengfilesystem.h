@@ -25,6 +25,29 @@
 
 namespace Teng {
 
+/** @short Read-only contents of file held in memory.
+ */
+class MappedFile_t {
+public:
+    MappedFile_t()
+        : data(0), size(0)
+    {}
+
+    virtual ~MappedFile_t() {}
+
+    /** @short Contents of the file.
+     */
+    const char *data;
+
+    /** @short Size of the contents.
+     */
+    std::string::size_type size;
+
+private:
+    MappedFile_t(const MappedFile_t&);
+    MappedFile_t operator=(const MappedFile_t&);
+};
+
 /** @short Abstract filesystem interface.
  */
 class FilesystemInterface_t {
@@ -36,6 +59,17 @@ public:
      */
     virtual std::string read(const std::string &filename) const = 0;
 
+    /**
+     * @short Map contents of file into memory.
+     * Default implementation keeps result of read() in memory.
+     * @param filename Name of the file in filesystem
+     * @param magic File is mapped only when it starts with magic
+     *              (otherwise it's read)
+     * @return Contents of the file (caller owns the object)
+     */
+    virtual MappedFile_t* map(const std::string &filename,
+                              const std::string &magic) const;
+
     virtual ~FilesystemInterface_t() {}
 };
 
@@ -44,6 +78,21 @@ public:
 class Filesystem_t : public FilesystemInterface_t {
 public:
     virtual std::string read(const std::string &filename) const;
+
+    /**
+     * @short Map file using mmap(2), so that it can be shared
+     *        among processes.
+     *
+     * Only files starting with magic (binary images) are mapped, other
+     * files are read (all files are read on Win32). Mapped file must be replaced by rename(2), never
+     * rewritten in place (access to truncated mapping raises SIGBUS).
+     *
+     * @param filename Name of the file in filesystem
+     * @param magic File is mapped only when it starts with magic
+     * @return Contents of the file (caller owns the object)
+     */
+    virtual MappedFile_t* map(const std::string &filename,
+                              const std::string &magic) const;
 };
 
 /** @short Implementation of filesystem interface backed by key-value storage.
@@ -35,102 +35,151 @@
  */
 
 
-#include <ctype.h>
+#include <algorithm>
 
 #include "tengformatter.h"
 
 namespace Teng {
 
-Formatter_t::Formatter_t(Writer_t &writer, Formatter_t::Mode_t initialMode)
-    : writer(writer), modeStack(), buffer()
+namespace {
+
+/** @short Table of whitespace characters (same as isspace() in the "C"
+ *         locale).
+ */
+struct WhiteTable_t {
+    WhiteTable_t() {
+        for (int i = 0; i < 256; ++i) white[i] = false;
+        white[static_cast<unsigned char>(' ')] = true;
+        white[static_cast<unsigned char>('\t')] = true;
+        white[static_cast<unsigned char>('\n')] = true;
+        white[static_cast<unsigned char>('\v')] = true;
+        white[static_cast<unsigned char>('\f')] = true;
+        white[static_cast<unsigned char>('\r')] = true;
+    }
+
+    bool white[256];
+};
+
+const WhiteTable_t whiteTable;
+
+inline bool isWhite(char c) {
+    return whiteTable.white[static_cast<unsigned char>(c)];
+}
+
+} // namespace
+
+Formatter_t::Formatter_t(Writer_t &writer, Formatter_t::Mode_t initialMode,
+                         unsigned int flushThreshold)
+    : writer(writer), modeStack(), buffer(), flushThreshold(flushThreshold),
+      unflushed(0), total(0)
 {
     // initialize mode stack with given initial mode
     modeStack.push(initialMode);
 }
 
 int Formatter_t::write(const std::string &str) {
+    if (format(str)) return -1;
+    return written(str.length());
+}
+
+int Formatter_t::format(const std::string &str) {
     // pass whole string when passing mode active
     if (modeStack.top() == MODE_PASSWHITE)
         return writer.write(str);
 
-    // indicates that we are in block of spaces
-    bool spaces = false;
-    // block of spaces
-    std::pair<std::string::const_iterator, std::string::const_iterator>
-        spaceblock = make_pair(str.begin(), str.begin());
-    // block of other characters
-    std::pair<std::string::const_iterator, std::string::const_iterator>
-        charblock = make_pair(str.begin(), str.begin());
-    // run through input string
-    for (std::string::const_iterator istr = str.begin();
-         istr != str.end(); ++istr) {
-        if (isspace(*istr)) {
-            // current character is white space
-            if (!spaces) {
-                // we were in block of characters when some characters
-                // are to be flushed flush them
-                if (charblock.first != charblock.second)
-                    if (writer.write(str, charblock))
-                        return -1;
-                // initialize space block
-                spaceblock.first = istr;
-                spaceblock.second = istr + 1;
-                // change context
-                spaces = true;
-            } else {
-                // advance one space
-                ++spaceblock.second;
-            }
-        } else {
-            if (istr == str.begin()) {
-                // string begins with text => process buffer
-                int ret = process(buffer);
-                buffer.erase();
-                if (ret) return ret;
-            }
-            if (spaces) {
-                // we were in block of spaces when some characters are
-                // to be processed process them
-                if ((spaceblock.first != spaceblock.second) || !buffer.empty())
-                    if (process(spaceblock))
-                        return -1;
-                // initialize character block
-                charblock.first = istr;
-                charblock.second = istr + 1;
-                // change context
-                spaces = false;
-            } else {
-                // advance one character
-                ++charblock.second;
-            }
-        }
+    std::string::const_iterator istr = str.begin();
+    std::string::const_iterator end = str.end();
+
+    // leading whitespaces continue run from previous call
+    if (!buffer.empty()) {
+        while ((istr != end) && isWhite(*istr)) ++istr;
+        buffer.append(str.begin(), istr);
+        // whole string is white => run may continue in next call
+        if (istr == end) return 0;
+        if (processBuffer()) return -1;
     }
 
-    // postprocessing
+    // start of data not written so far
+    std::string::const_iterator pending = istr;
+    while (istr != end) {
+        // skip block of other characters
+        while ((istr != end) && !isWhite(*istr)) ++istr;
+        if (istr == end) break;
 
-    // get rid of current buffer
-    buffer.erase();
-    if (spaces) {
-        // we were in block of spaces so we must remember them for
-        // next round
-        if (spaceblock.first != spaceblock.second)
-            buffer.append(spaceblock.first, spaceblock.second);
-    } else {
-        // we were in block of characters when some characters are to
-        // be flushed flush them
-        if (charblock.first != charblock.second)
-            if (writer.write(str, charblock))
-                return -1;
+        // find run of whitespaces
+        std::string::const_iterator white = istr;
+        while ((istr != end) && isWhite(*istr)) ++istr;
+        if (istr == end) {
+            // run may continue in next call => remember it
+            buffer.append(white, end);
+            end = white;
+            break;
+        }
+
+        // format run; unchanged run is written with surrounding text
+        std::string::const_iterator head;
+        std::string::const_iterator tail;
+        const char *replacement;
+        reduce(white, istr, head, replacement, tail);
+        if (head == istr) continue;
+        if (emit(str, pending, head)) return -1;
+        if (replacement && writer.write(replacement)) return -1;
+        pending = tail;
     }
 
-    // OK
-    return 0;
+    // write rest of data
+    return emit(str, pending, end);
+}
+
+int Formatter_t::writeStatic(const std::string &str) {
+    // only passing mode keeps string intact
+    if (modeStack.top() != MODE_PASSWHITE) return write(str);
+    if (writer.writeStatic(str)) return -1;
+    return written(str.length());
+}
+
+int Formatter_t::writePreformatted(const std::string &str) {
+    // passing mode writes everything verbatim
+    if (modeStack.top() == MODE_PASSWHITE) return writeStatic(str);
+
+    // find inner part
+    std::string::const_iterator first = str.begin();
+    std::string::const_iterator last = str.end();
+    while ((first != last) && isWhite(*first)) ++first;
+    if (first == last) return write(str);
+    while (isWhite(*(last - 1))) --last;
+
+    // leading whitespaces continue run from previous call
+    buffer.append(str.begin(), first);
+    if (processBuffer()) return -1;
+
+    // inner part is ready
+    if (emit(str, first, last)) return -1;
+
+    // trailing whitespaces may continue in next call
+    buffer.append(last, str.end());
+    return written(str.length());
+}
+
+int Formatter_t::written(std::string::size_type length) {
+    total += length;
+    // streaming disabled
+    if (!flushThreshold) return 0;
+    // flush writer when enough data were written
+    unflushed += length;
+    if (unflushed < flushThreshold) return 0;
+    return flushWriter();
+}
+
+int Formatter_t::flushWriter() {
+    unflushed = 0;
+    return writer.flush();
 }
 
 int Formatter_t::flush() {
     // flush buffer
     if (!buffer.empty())
-        if (process(buffer)) return -1;
+        if (processBuffer()) return -1;
     // flush writer
     return writer.flush();
 }
@@ -138,7 +187,7 @@ int Formatter_t::flush() {
 int Formatter_t::push(Mode_t mode) {
     // flush buffer
     if (!buffer.empty())
-        if (process(buffer)) return -1;
+        if (processBuffer()) return -1;
     // push new mode
     modeStack.push(mode);
     // OK
@@ -150,7 +199,7 @@ Formatter_t::Mode_t Formatter_t::pop() {
     if (modeStack.size() <= 1) return MODE_INVALID;
     // flush buffer
     if (!buffer.empty())
-        if (process(buffer)) return MODE_INVALID;
+        if (processBuffer()) return MODE_INVALID;
     // get old mode
     Mode_t oldMode = modeStack.top();
     // remove old mode
@@ -159,26 +208,15 @@ Formatter_t::Mode_t Formatter_t::pop() {
     return oldMode;
 }
 
-int Formatter_t::
-process(std::pair<std::string::const_iterator,
-        std::string::const_iterator> spaceBlock)
+void Formatter_t::reduce(std::string::const_iterator begin,
+                         std::string::const_iterator end,
+                         std::string::const_iterator &head,
+                         const char *&replacement,
+                         std::string::const_iterator &tail) const
 {
-    if (modeStack.top() == MODE_NOWHITE) {
-        // output of spaces disabled
-        buffer.erase();
-        return 0;
-    }
-    // append buffer by space list
-    buffer.append(spaceBlock.first, spaceBlock.second);
-    // process buffer
-    int ret = process(buffer);
-    buffer.erase();
-    return ret;
-}
-
-int Formatter_t::process(std::string &str) {
-    // ignore empty space block
-    if (str.empty()) return 0;
+    // keep whole run by default
+    head = tail = end;
+    replacement = 0;
 
     // process spaces according to current mode
     switch (modeStack.top()) {
@@ -187,73 +225,70 @@ int Formatter_t::process(std::string &str) {
         // rule
         // NO BREAK!!!
     case MODE_PASSWHITE:
-        // pass whole string to the writer
-        if (writer.write(str))
-            return -1;
+        // pass whole run
         break;
     case MODE_NOWHITE:
         // no space to output
+        head = begin;
         break;
     case MODE_ONESPACE:
         // pass just one space
-        if (writer.write(" "))
-            return -1;
+        if (((end - begin) != 1) || (*begin != ' ')) {
+            head = begin;
+            replacement = " ";
+        }
         break;
     case MODE_STRIPLINES:
-        {
-            // find newline
-            std::string::size_type nl = str.find('\n');
-            if (nl == std::string::npos) {
-                // no newline found => pass whole string
-                if (writer.write(str)) return -1;
-            } else {
-                // newline found => pass just one newline
-                if (writer.write("\n"))  return -1;
-            }
+        // newline found => pass just one newline; otherwise pass
+        // whole run
+        if ((std::find(begin, end, '\n') != end) && ((end - begin) != 1)) {
+            head = begin;
+            replacement = "\n";
         }
         break;
     case MODE_JOINLINES:
-        {
-            // find newline
-            std::string::size_type nl = str.find('\n');
-            if (nl == std::string::npos) {
-                // no newline found => pass whole string
-                if (writer.write(str)) return -1;
-            } else {
-                // newline found => pass leading whitespaces upto the
-                // newline
-                if (writer.write(str.substr(0, nl))) return -1;
-            }
-        }
+        // pass leading whitespaces upto the newline (or whole run
+        // when there is no newline)
+        head = std::find(begin, end, '\n');
         break;
     case MODE_NOWHITELINES:
         {
             // find newline
-            std::string::size_type fnl = str.find('\n');
-            if (fnl == std::string::npos) {
-                // no newline found => pass whole string
-                if (writer.write(str)) return -1;
-                break;
-            }
-            // find newline from the end of string
-            std::string::size_type lnl = str.rfind('\n');
-            if (fnl == lnl) {
-                // indices are the same => single newline
-                // => pass whole string
-                if (writer.write(str)) return -1;
-                break;
-            }
-            // more newlines => pass leading whitespaces upto then
+            std::string::const_iterator fnl = std::find(begin, end, '\n');
+            if (fnl == end) break;
+            // find newline from the end of run
+            std::string::const_iterator lnl = end;
+            while (*--lnl != '\n');
+            // single newline => pass whole run
+            if (fnl == lnl) break;
+            // more newlines => pass leading whitespaces upto the
             // first newline and trailing whitespaces from the last
             // newline
-            if (writer.write(str.substr(0, fnl + 1))) return -1;
-            if (writer.write(str.substr(lnl + 1))) return -1;
+            head = fnl + 1;
+            tail = lnl + 1;
         }
         break;
     }
+}
+
+int Formatter_t::processBuffer() {
+    // ignore empty run
+    if (buffer.empty()) return 0;
+
+    std::string::const_iterator head;
+    std::string::const_iterator tail;
+    const char *replacement;
+    reduce(buffer.begin(), buffer.end(), head, replacement, tail);
+
+    int ret = 0;
+    if (emit(buffer, buffer.begin(), head)
+        || (replacement && writer.write(replacement))
+        || emit(buffer, tail, buffer.end()))
+        ret = -1;
+
     // erase buffer
     buffer.erase();
-    return 0;
+    return ret;
 }
 
 } // namespace Teng
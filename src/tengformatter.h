@@ -71,8 +71,11 @@ public:
     /** @short Create new formatter.
      *  @param writer output writer
      *  @param initialMode initial mode of formatting
+     *  @param flushThreshold flush writer each time so many bytes
+     *                        were written (0 = never)
      */
-    Formatter_t(Writer_t &writer, Mode_t initialMode = MODE_PASSWHITE);
+    Formatter_t(Writer_t &writer, Mode_t initialMode = MODE_PASSWHITE,
+                unsigned int flushThreshold = 0);
 
     /** @short Write string to output.
      *  @param str string to be written
@@ -80,11 +83,40 @@ public:
      */
     int write(const std::string &str);
 
+    /** @short Write string that lives until flush() to output.
+     *  @param str string to be written
+     *  @return 0 OK, !0 error
+     */
+    int writeStatic(const std::string &str);
+
+    /** @short Write static text whose inner whitespaces are already
+     *         formatted for the current mode.
+     *  Only leading and trailing whitespaces are processed (they can
+     *  join with adjacent output).
+     *  @param str string to be written
+     *  @return 0 OK, !0 error
+     */
+    int writePreformatted(const std::string &str);
+
     /** @short Flushes buffered data.
      *  @return 0 OK, !0 error
      */
     int flush();
 
+    /** @short Flushes writer only.
+     *  Whitespaces buffered for formatting are kept so the output is
+     *  the same as without flush.
+     *  @return 0 OK, !0 error
+     */
+    int flushWriter();
+
+    /** @short Get number of bytes passed to the formatter.
+     *  @return size of unformatted output
+     */
+    inline unsigned long int getWritten() const {
+        return total;
+    }
+
     /** @short Pushes new formatting mode to the stack.
      *  @param mode new formatting mode
      *  @return 0 OK, !0 error
@@ -110,18 +142,54 @@ private:
      */
     Formatter_t operator=(const Formatter_t&);
 
-    /** @short Process sequence of spaces.
-     *  @param spaceBlock block of spaces
+    /** @short Format string and write it to output.
+     *  @param str string to be written
      *  @return 0 OK, !0 error
      */
-    int process(std::pair<std::string::const_iterator,
-                std::string::const_iterator> spaceBlock);
+    int format(const std::string &str);
 
-    /** @short Process sequence of spaces.
-     *  @param str white string
+    /** @short Account written data and flush writer when streaming
+     *         threshold is reached.
+     *  @param length length of written data
+     *  @return 0 OK, !0 error
+     */
+    int written(std::string::size_type length);
+
+    /** @short Compute formatted form of run of whitespaces.
+     *
+     *  Formatted run is [begin, head) + replacement + [tail, end);
+     *  the run is left intact when head == end.
+     *
+     *  @param begin start of run
+     *  @param end end of run
+     *  @param head end of kept leading part (output)
+     *  @param replacement inserted string or 0 (output)
+     *  @param tail start of kept trailing part (output)
+     */
+    void reduce(std::string::const_iterator begin,
+                std::string::const_iterator end,
+                std::string::const_iterator &head,
+                const char *&replacement,
+                std::string::const_iterator &tail) const;
+
+    /** @short Write part of string to the writer.
+     *  @param str string
+     *  @param begin start of part
+     *  @param end end of part
+     *  @return 0 OK, !0 error
+     */
+    inline int emit(const std::string &str,
+                    std::string::const_iterator begin,
+                    std::string::const_iterator end)
+    {
+        if (begin == end) return 0;
+        return writer.write(str, std::make_pair(begin, end));
+    }
+
+    /** @short Format buffered run of whitespaces and write it.
      *  @return 0 OK, !0 error
      */
-    int process(std::string &str);
+    int processBuffer();
 
     /** @short Output writer.
      */
@@ -134,6 +202,18 @@ private:
     /** @short Buffer of whitespaces from previous run.
      */
     std::string buffer;
+
+    /** @short Flush writer after so many bytes (0 = never).
+     */
+    unsigned int flushThreshold;
+
+    /** @short Bytes written since last flush.
+     */
+    unsigned int unflushed;
+
+    /** @short Bytes written since creation.
+     */
+    unsigned long int total;
 };
 
 } // namespace Teng
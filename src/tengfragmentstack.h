@@ -39,6 +39,7 @@
 
 #include <string>
 #include <vector>
+#include <deque>
 #include <map>
 #include <algorithm>
 #include <utility>
@@ -64,6 +65,8 @@ const std::string LEVEL("level");
 
 const std::string MESSAGE("message");
 
+const std::string COUNT("count");
+
 enum Status_t {
     S_OK =               0,
     S_NOT_FOUND =       -1,
@@ -72,93 +75,98 @@ enum Status_t {
     S_ALREADY_DEFINED = -4,
     S_TYPE_MISMATCH =   -5,
     S_NO_ITERATIONS =   -6,
+    S_TOO_DEEP =        -7,
 };
 
-class FragmentFrame_t {
-public:
-    inline FragmentFrame_t() {
-    }
-
-    inline virtual ~FragmentFrame_t() {
-        // no-op
-    }
-
-    virtual const FragmentList_t *findSubFragment(const std::string &name)
-        const = 0;
-
-    virtual Status_t findVariable(const std::string &name,
-                                  ParserValue_t &var) const = 0;
-
-    virtual bool nextIteration() = 0;
-
-    virtual bool overflown() = 0;
-
-    virtual unsigned int size() const = 0;
-
-    virtual unsigned int iteration() const = 0;
-
-    virtual bool exists(const std::string &name,
-                        bool onlyData = false) const = 0;
-
-    virtual const Fragment_t *getCurrentFragment() const = 0;
-
-    bool localExists(const std::string &name) const {
-        return (locals.find(name) != locals.end());
-    }
+/** @short Repeated fragment (<?teng repeatfrag?>).
+ */
+struct FragmentRepeat_t {
+    unsigned int frame;      //!< position of repeated frame
+    unsigned int chainStart; //!< start of current chain before repeat
+    int returnAddress;       //!< address of instruction after repeat
+};
 
-    inline Status_t findLocalVariable(const std::string &name, ParserValue_t &var,
-                                      bool testExistence = false)
-        const
+/** @short Local variables of fragment frame.
+ *
+ * Variables are addressed by slots assigned at compile time. Values are
+ * valid only in the generation (iteration) which has set them so all
+ * variables are cleared in O(1) and the buffer is reused.
+ */
+class FragmentLocals_t {
+public:
+    FragmentLocals_t()
+        : slots(), generation(0)
     {
-        // try to find variable
-        std::map<std::string, ParserValue_t>::const_iterator flocals
-            = locals.find(name);
-        if (flocals == locals.end()) return S_NOT_FOUND;
-
-        // check whether we are only checking for existence
-        if (testExistence) return S_OK;
-
-        // found => assing
-        var = flocals->second;
-
-        // OK
-        return S_OK;
+        // no-op
     }
 
-    inline Status_t setVariable(const std::string &name,
-                                const ParserValue_t &var)
-    {
-        // check whether there is non-local variable with given name
-        // -- we are not allowed to override data from template
-        if (exists(name, true)) return S_ALREADY_DEFINED;
-
-        // try to insert value to local variables
-        std::pair<std::map<std::string, ParserValue_t>::iterator, bool>
-            insertResult = locals.insert(make_pair(name, var));
-        if (!insertResult.second) {
-            // unsuccesful (already set) -- change its value
-            insertResult.first->second = var;
+    /** @short Clears all variables.
+     */
+    inline void reset() {
+        if (!++generation) {
+            // generation overflow => invalidate all slots explicitly
+            for (std::vector<Slot_t>::iterator islots = slots.begin();
+                 islots != slots.end(); ++islots)
+                islots->generation = 0;
+            generation = 1;
         }
+    }
 
-        // OK
-        return S_OK;
+    /** @short Finds variable.
+     * @param slot slot of variable
+     * @return variable's value or 0 when not set
+     */
+    inline const ParserValue_t* find(int slot) const {
+        if ((slot < 0) || (static_cast<unsigned int>(slot) >= slots.size())
+            || (slots[slot].generation != generation)) return 0;
+        return &slots[slot].value;
     }
 
-    inline void resetLocals() {
-        // remove all local variables (only when non empty)
-        if (!locals.empty())
-            locals = std::map<std::string, ParserValue_t>();
+    /** @short Sets variable.
+     * @param slot slot of variable (must be non-negative)
+     * @param value new value
+     */
+    inline void set(int slot, const ParserValue_t &value) {
+        if (static_cast<unsigned int>(slot) >= slots.size())
+            slots.resize(slot + 1);
+        slots[slot].generation = generation;
+        slots[slot].value = value;
     }
 
 private:
-    std::map<std::string, ParserValue_t> locals;
+    /** @short Value with generation of its assignment.
+     */
+    struct Slot_t {
+        Slot_t() : generation(0), value() {}
+
+        unsigned int generation;
+        ParserValue_t value;
+    };
+
+    std::vector<Slot_t> slots;
+    unsigned int generation;
 };
 
-class RegularFragmentFrame_t : public FragmentFrame_t {
+/** @short Frame of processed fragment (fragment from data tree or error
+ *         fragment).
+ *
+ * Frames are stored by value (type of frame is held in tag) so entering
+ * and leaving fragment doesn't allocate.
+ */
+class FragmentFrame_t {
 public:
-    RegularFragmentFrame_t(const FragmentList_t *fragmentList = 0)
-        : FragmentFrame_t(),
-          fragment(fragmentList
+    /** @short Type of frame.
+     */
+    enum Type_t {
+        FT_REGULAR,  //!< fragment from data tree
+        FT_ERROR,    //!< error fragment
+        FT_COLUMNAR  //!< row of columnar fragment list
+    };
+
+    FragmentFrame_t(const FragmentList_t *fragmentList = 0)
+        : type((fragmentList && fragmentList->isColumnar())
+               ? FT_COLUMNAR : FT_REGULAR),
+          fragment(((type == FT_REGULAR) && fragmentList)
                    ? (fragmentList->empty() ? 0 : *fragmentList->begin())
                    : 0),
 #ifndef WIN32
@@ -167,8 +175,10 @@ public:
           dataEnd(fragmentList ? fragmentList->end()
                   : FragmentList_t::const_iterator()),
 #endif //WIN32
+          errors(0), columnar((type == FT_COLUMNAR) ? fragmentList : 0),
           dataSize(fragmentList ? fragmentList->size() : 0),
-          index(0)
+          index(0), locals(0), cachedName(0), cachedIteration(0),
+          cachedSize(0)
     {
 #ifdef WIN32
         if (fragmentList)
@@ -180,63 +190,136 @@ public:
         // no-op
     }
 
-    RegularFragmentFrame_t(const Fragment_t *fragment)
-        : FragmentFrame_t(),
-          fragment(fragment),
+    FragmentFrame_t(const Fragment_t *fragment)
+        : type(FT_REGULAR), fragment(fragment),
 #ifndef WIN32
           data(FragmentList_t::const_iterator()),
           dataEnd(FragmentList_t::const_iterator()),
 #endif //WIN32
-          dataSize(1), index(0)
+          errors(0), columnar(0), dataSize(1), index(0), locals(0),
+          cachedName(0), cachedIteration(0), cachedSize(0)
     {
         // no-op
     }
 
-    virtual bool exists(const std::string &name, bool onlyData = false) const {
-        Fragment_t::const_iterator ffragment = fragment->find(name);
-        if (ffragment != fragment->end()) {
-            // we have found identifier in data
-            if (ffragment->second->nestedFragments) {
-                // identifier is fragment -- we have test whether it has any
-                // iteration
-                if (!ffragment->second->nestedFragments->empty())
-                    return true;
-                // fragment is empty => there can be local variable of
-                // this name
-            } else return true; // identifier is variable => exists
+    FragmentFrame_t(const Error_t &error)
+        : type(FT_ERROR), fragment(0),
+#ifndef WIN32
+          data(FragmentList_t::const_iterator()),
+          dataEnd(FragmentList_t::const_iterator()),
+#endif //WIN32
+          errors(&error.getEntries()), columnar(0), dataSize(error.count()),
+          index(0),
+          locals(0), cachedName(0), cachedIteration(0), cachedSize(0)
+    {
+        // no-op
+    }
+
+    /** @short Attaches buffer for local variables (variables are
+     *         cleared).
+     */
+    inline void attachLocals(FragmentLocals_t &buffer) {
+        locals = &buffer;
+        locals->reset();
+    }
+
+    inline bool exists(const Identifier_t &id, bool onlyData = false) const {
+        const std::string &name = id.name;
+        switch (type) {
+        case FT_REGULAR: {
+            Fragment_t::const_iterator ffragment = fragment->find(name);
+            if (ffragment != fragment->end()) {
+                // we have found identifier in data
+                if (ffragment->second->nestedFragments) {
+                    // identifier is fragment -- we have test whether it
+                    // has any iteration
+                    if (!ffragment->second->nestedFragments->empty())
+                        return true;
+                    // fragment is empty => there can be local variable of
+                    // this name
+                } else return true; // identifier is variable => exists
+            }
+            break;
         }
-        return onlyData ? false : localExists(name);
+
+        case FT_ERROR:
+            if ((name == FILENAME) || (name == LINE)
+                || (name == COLUMN) || (name == LEVEL)
+                || (name == MESSAGE) || (name == COUNT)) return true;
+            break;
+
+        case FT_COLUMNAR:
+            if (columnar->findColumn(name) >= 0) return true;
+            break;
+        }
+        return onlyData ? false : localExists(id.slot);
     }
 
-    virtual const FragmentList_t *
+    inline const FragmentList_t *
     findSubFragment(const std::string &name) const {
-        std::map<std::string, FragmentValue_t*>::const_iterator subFragment
+        // error fragment and columnar row have no descendants
+        if (type != FT_REGULAR) return 0;
+
+        Fragment_t::const_iterator subFragment
             = fragment->find(name);
         return ((subFragment == fragment->end()) ? 0
                 : subFragment->second->nestedFragments);
     }
 
-    virtual Status_t findVariable(const std::string &name, ParserValue_t &var)
+    inline Status_t findVariable(const Identifier_t &id, ParserValue_t &var,
+                                 const FragmentValue_t **source = 0)
         const
     {
+        switch (type) {
+        case FT_REGULAR:
+            break;
+        case FT_ERROR:
+            return findErrorVariable(id, var);
+        case FT_COLUMNAR:
+            return findColumnarVariable(id, var);
+        }
+
         // try to find variable in the associated fragment
-        std::map<std::string, FragmentValue_t*>::const_iterator element
-            = fragment->find(name);
+        Fragment_t::const_iterator element
+            = fragment->find(id.name);
 
         // when not found => try to find local variable
         if (element == fragment->end())
-            return findLocalVariable(name, var);
+            return findLocalVariable(id.slot, var);
 
         // check whether found element is value (has no nested fragments)
         if (element->second->nestedFragments)
             return S_TYPE_MISMATCH;
 
         // OK we have variable's value from data tree!
-        var.setString(element->second->value);
+        const FragmentValue_t &value = *element->second;
+        switch (value.type) {
+        case FragmentValue_t::TYPE_INT:
+            var.setInteger(value.integerValue, value.value);
+            break;
+        case FragmentValue_t::TYPE_REAL:
+            var.setReal(value.realValue, value.value);
+            break;
+        default:
+            var.setString(value.value);
+            break;
+        }
+        if (source) *source = element->second;
         return S_OK;
     }
 
-    virtual bool nextIteration() {
+    inline bool nextIteration() {
+        if (type != FT_REGULAR) {
+            // check for end
+            if (index == dataSize) return false;
+
+            // reset local variables;
+            resetLocals();
+
+            // increment index and return whether we have not runaway
+            return (++index != dataSize);
+        }
+
         // check for end
         if (data == dataEnd) return false;
 
@@ -256,343 +339,349 @@ public:
         return true;
     }
 
-    virtual bool overflown() {
-        // we have only one iteration
+    inline bool overflown() const {
+        if (type != FT_REGULAR) return index == dataSize;
         return data == dataEnd;
     }
 
-    virtual unsigned int size() const {
+    inline unsigned int size() const {
         return dataSize;
     }
 
-    virtual unsigned int iteration() const {
+    inline unsigned int iteration() const {
         return index;
     }
 
-    virtual const Fragment_t *getCurrentFragment() const {
-        return fragment;
-    }
-
-private:
-    const Fragment_t *fragment;
-    FragmentList_t::const_iterator data;
-    FragmentList_t::const_iterator dataEnd;
-
-    unsigned int dataSize;
-    unsigned int index;
-};
-
-class ErrorFragmentFrame_t : public FragmentFrame_t {
-public:
-    inline ErrorFragmentFrame_t(const Error_t &error)
-        : FragmentFrame_t(), errors(error.getEntries()),
-          errorSize(error.count()), index(0)
-
-    {
-        // no-op
+    /** @short Returns whether current iteration is the first one.
+     */
+    inline bool isFirst() const {
+        return !index;
     }
 
-    virtual bool exists(const std::string &name, bool onlyData = false) const {
-        if ((name == FILENAME) || (name == LINE)
-             || (name == COLUMN) || (name == LEVEL)
-            || (name == MESSAGE)) return true;
-        return onlyData ? false : localExists(name);
+    /** @short Returns whether current iteration is the last one.
+     */
+    inline bool isLast() const {
+        return (index + 1) == dataSize;
     }
 
-    virtual const FragmentList_t *
-    findSubFragment(const std::string &name) const {
-        // error fragment has no descendants
-        return 0;
+    /** @short Returns whether current iteration is neither the first
+     *         nor the last one.
+     */
+    inline bool isInner() const {
+        return index && ((index + 1) < dataSize);
     }
 
-    virtual Status_t findVariable(const std::string &name, ParserValue_t &var)
-        const
-    {
-        // try to match variable names
-        if (name == FILENAME) {
-            const std::string &filename = errors[index].pos.filename;
-            var.setString(filename.empty() ? NO_FILE : filename);
-            return S_OK;
-        } else if (name == LINE) {
-            var.setInteger(errors[index].pos.lineno);
-            return S_OK;
-        } else if (name == COLUMN) {
-            var.setInteger(errors[index].pos.col);
-            return S_OK;
-        } else if (name == LEVEL) {
-            var.setInteger(errors[index].level);
-            return S_OK;
-        } else if (name == MESSAGE) {
-            var.setString(errors[index].message);
-            return S_OK;
+    /** @short Returns size of nested fragment (0 when not present).
+     *
+     * Size is cached for the last used name (compared by address, it is
+     * name from instruction) in current iteration.
+     */
+    inline unsigned int getSubFragmentSize(const std::string &name) const {
+        if ((cachedName != &name) || (cachedIteration != index)) {
+            const FragmentList_t *subFragment = findSubFragment(name);
+            cachedSize = subFragment ? subFragment->size() : 0;
+            cachedName = &name;
+            cachedIteration = index;
         }
-
-        // nothing matched, return local variable
-        return findLocalVariable(name, var);
+        return cachedSize;
     }
 
-    virtual bool nextIteration() {
-        // check for end
-        if (index == errorSize) return false;
-
-        // reset local variables;
-        resetLocals();
-
-        // increment data iterator and return whether we have not runaway
-        return (++index != errorSize);
-    }
-
-    virtual bool overflown() {
-        // we have only one iteration
-        return index == errorSize;
-    }
-
-    virtual unsigned int size() const {
-        return errorSize;
+    inline const Fragment_t *getCurrentFragment() const {
+        // error fragment and columnar row have no fragment
+        return fragment;
     }
 
-    virtual unsigned int iteration() const {
-        return index;
+    /** @short Returns columnar list (0 when frame is not columnar),
+     *         current row is iteration().
+     */
+    inline const FragmentList_t *getColumnarList() const {
+        return columnar;
     }
 
-    virtual const Fragment_t *getCurrentFragment() const {
-        return 0;
+    bool localExists(int slot) const {
+        return locals && locals->find(slot);
     }
 
-private:
-    const std::vector<Error_t::Entry_t> &errors;
-    unsigned int errorSize;
-    unsigned int index;
-};
+    inline Status_t findLocalVariable(int slot, ParserValue_t &var,
+                                      bool testExistence = false)
+        const
+    {
+        // try to find variable
+        const ParserValue_t *value = locals ? locals->find(slot) : 0;
+        if (!value) return S_NOT_FOUND;
 
-class FragmentChain_t {
-public:
-    inline FragmentChain_t(FragmentFrame_t *rootFrame) {
-        frames.reserve(100);
-        frames.push_back(rootFrame);
-    }
+        // check whether we are only checking for existence
+        if (testExistence) return S_OK;
 
-    inline ~FragmentChain_t() {
-        // get rid of all remaining frames
-        for (std::vector<FragmentFrame_t*>::iterator iframes = frames.begin();
-             iframes != frames.end(); ++iframes)
-            if (iframes != frames.begin())
-                delete *iframes;
-    }
+        // found => assing
+        var = *value;
 
-    inline void pushFrame(const std::string &name, FragmentFrame_t *frame) {
-        path.push_back(name);
-        frames.push_back(frame);
+        // OK
+        return S_OK;
     }
 
-    inline Status_t popFrame() {
-        // check for underflow
-        if (path.empty()) return S_OUT_OF_CONTEXT;
+    inline Status_t setVariable(const Identifier_t &id,
+                                const ParserValue_t &var)
+    {
+        // variable without slot cannot be set
+        if (!locals || (id.slot < 0)) return S_BAD;
 
-        // remove last path part
-        path.pop_back();
+        // check whether there is non-local variable with given name
+        // -- we are not allowed to override data from template (not
+        // needed when already set in this iteration)
+        if (!locals->find(id.slot) && exists(id, true))
+            return S_ALREADY_DEFINED;
 
-        // remove and delete last frame
-        delete frames.back();
-        frames.pop_back();
+        // set value of local variable
+        locals->set(id.slot, var);
 
         // OK
         return S_OK;
     }
 
-    inline const FragmentList_t *
-    findSubFragment(const std::string &name) const {
-        return frames.back()->findSubFragment(name);
-    }
-
-    inline Status_t findVariable(const Identifier_t &name, ParserValue_t &var)
-        const
-    {
-        // check for range
-        if (name.depth > frames.size()) return S_OUT_OF_CONTEXT;
-        return (*(frames.begin() + name.depth))->findVariable(name.name, var);
-    }
-
-    inline Status_t setVariable(const Identifier_t &name,
-                                const ParserValue_t &var)
-    {
-        // check for range
-        if (name.depth > frames.size()) return S_OUT_OF_CONTEXT;
-        return (*(frames.begin() + name.depth))->setVariable(name.name, var);
+    inline void resetLocals() {
+        // remove all local variables
+        if (locals) locals->reset();
     }
 
-    inline Status_t getFragmentSize(const Identifier_t &name,
-                               unsigned int &fragmentSize)
+private:
+    Status_t findColumnarVariable(const Identifier_t &id, ParserValue_t &var)
         const
     {
-        // check for range
-        if (name.depth > path.size()) return S_OUT_OF_CONTEXT;
-
-        // get size
-        fragmentSize = (*(frames.begin() + name.depth))->size();
+        // try to find column, not found => try to find local variable
+        int column = columnar->findColumn(id.name);
+        if (column < 0) return findLocalVariable(id.slot, var);
+
+        std::string buffer;
+        const std::string &value = columnar->getValue(index, column, buffer);
+        switch (columnar->getColumnType(column)) {
+        case FragmentList_t::COLUMN_INT:
+            var.setInteger(columnar->getInteger(index, column), value);
+            break;
+        case FragmentList_t::COLUMN_REAL:
+            var.setReal(columnar->getReal(index, column), value);
+            break;
+        default:
+            var.setString(value);
+            break;
+        }
         return S_OK;
     }
 
-    inline Status_t getSubFragmentSize(const Identifier_t &name,
-                                       unsigned int &fragmentSize)
+    Status_t findErrorVariable(const Identifier_t &id, ParserValue_t &var)
         const
     {
-        // check for range
-        if (name.depth > path.size()) return S_OUT_OF_CONTEXT;
-
-        // find subfragment by name
-        const FragmentList_t *subFragment
-            = (*(frames.begin() + name.depth))->findSubFragment(name.name);
-        if (subFragment) {
-            // get size
-            fragmentSize = subFragment->size();
-        } else {
-            // subfragment not present, treating as zero size
-            fragmentSize = 0;
+        const std::string &name = id.name;
+        const Error_t::Entry_t &entry = (*errors)[index];
+
+        // try to match variable names
+        if (name == FILENAME) {
+            const std::string &filename = entry.pos.filename;
+            var.setString(filename.empty() ? NO_FILE : filename);
+            return S_OK;
+        } else if (name == LINE) {
+            var.setInteger(entry.pos.lineno);
+            return S_OK;
+        } else if (name == COLUMN) {
+            var.setInteger(entry.pos.col);
+            return S_OK;
+        } else if (name == LEVEL) {
+            var.setInteger(entry.level);
+            return S_OK;
+        } else if (name == MESSAGE) {
+            var.setString(entry.message);
+            return S_OK;
+        } else if (name == COUNT) {
+            var.setInteger(entry.count);
+            return S_OK;
         }
 
-        // OK
-        return S_OK;
+        // nothing matched, return local variable
+        return findLocalVariable(id.slot, var);
     }
 
-    inline Status_t getFragmentIteration(const Identifier_t &name,
-                                         unsigned int &fragmentIteration,
-                                         unsigned int *fragmentSize = 0)
-        const
-    {
-        // check for range
-        if (name.depth > path.size()) return S_OUT_OF_CONTEXT;
+    Type_t type;
 
-        FragmentFrame_t &frame = *(*(frames.begin() + name.depth));
+    const Fragment_t *fragment;
+    FragmentList_t::const_iterator data;
+    FragmentList_t::const_iterator dataEnd;
 
-        // get iteration and optional size
-        fragmentIteration = frame.iteration();
-        if (fragmentSize) *fragmentSize = frame.size();
-        return S_OK;
-    }
+    const std::vector<Error_t::Entry_t> *errors;
 
-    inline bool exists(const Identifier_t &name) const {
-        // check for range
-        if (name.depth > path.size()) return false;
+    const FragmentList_t *columnar;
 
-        // test for existence
-        return (*(frames.begin() + name.depth))->exists(name.name);
-    };
+    unsigned int dataSize;
+    unsigned int index;
 
-    inline bool empty() const {
-        // check for empty path
-        return path.empty();
-    }
+    FragmentLocals_t *locals;
 
-    inline unsigned int size() const {
-        // check for empty path
-        return path.size();
-    }
+    mutable const std::string *cachedName; //!< name of cached fragment
+    mutable unsigned int cachedIteration;  //!< iteration of cached size
+    mutable unsigned int cachedSize;       //!< cached size of fragment
+};
 
-    inline bool nextIteration() {
-        return frames.back()->nextIteration();
+/** @short Storage of fragment frames.
+ *
+ * Storage keeps its capacity between runs so it can be reused by
+ * subsequent fragment stacks (one at a time).
+ */
+class FragmentStorage_t {
+public:
+    FragmentStorage_t()
+        : frames(), chains(), repeats(), locals(), rootLocals(), used(false)
+    {
+        // no-op
     }
 
-    inline bool overflown() {
-        return frames.back()->overflown();
+    /** @short Returns buffer for local variables of frame at given
+     *         position (buffers are never moved).
+     */
+    FragmentLocals_t& localsAt(unsigned int position) {
+        if (position >= locals.size()) locals.resize(position + 1);
+        return locals[position];
     }
 
-    virtual const Fragment_t *getCurrentFragment() const {
-        return frames.back()->getCurrentFragment();
-    }
+    /** @short Frames of all chains (without root frame).
+     */
+    std::vector<FragmentFrame_t> frames;
 
+    /** @short Index of first frame of each chain in frames.
+     */
+    std::vector<unsigned int> chains;
 
-private:
-    std::vector<std::string> path;
+    /** @short Stack of repeated fragments.
+     */
+    std::vector<FragmentRepeat_t> repeats;
 
-    std::vector<FragmentFrame_t*> frames;
-};
+    /** @short Buffers for local variables of frames (by position).
+     */
+    std::deque<FragmentLocals_t> locals;
 
+    /** @short Buffer for local variables of root frame.
+     */
+    FragmentLocals_t rootLocals;
+
+    /** @short Storage is used by some fragment stack.
+     */
+    bool used;
+};
 
 class FragmentStack_t {
 public:
+    /** @short Creates fragment stack.
+     * @param data root fragment
+     * @param error error log (source of error fragment)
+     * @param enableErrorFragment enables error fragment
+     * @param reusable storage for frames (own storage is used when 0
+     *                 or used by other stack)
+     */
     FragmentStack_t(const Fragment_t *data, Error_t &error,
-                    bool enableErrorFragment = false)
+                    bool enableErrorFragment = false,
+                    FragmentStorage_t *reusable = 0)
         : data(data), error(error), enableErrorFragment(enableErrorFragment),
-          root(data)
+          root(data), ownStorage(),
+          storage((reusable && !reusable->used) ? *reusable : ownStorage),
+          frames(storage.frames), chains(storage.chains),
+          repeats(storage.repeats)
     {
-        // reserve some space and create new fragment chain for whole
-        // page
-        chains.reserve(20);
-        chains.push_back(&root);
+        storage.used = true;
+        frames.clear();
+        chains.clear();
+        repeats.clear();
+
+        // create new fragment chain for whole page
+        chains.push_back(0);
+        root.attachLocals(storage.rootLocals);
     }
 
     ~FragmentStack_t() {
+        // get rid of frames, capacity is kept for next run
+        frames.clear();
+        chains.clear();
+        repeats.clear();
+        storage.used = false;
     }
 
     inline Status_t pushFrame(const Identifier_t &name) {
         if (name.context) {
             // check whether context has been changed
-            chains.push_back(&root);
+            chains.push_back(frames.size());
         }
 
-        // get current chain
-        FragmentChain_t &chain = chains.back();
-
-         // create fragment frame
-        FragmentFrame_t *frame;
-
         // create new frame
-        if (enableErrorFragment && chain.empty()
+        if (enableErrorFragment && chainEmpty()
             && (name.name == ERROR_FRAG_NAME)) {
             // error fragment
-            frame = new ErrorFragmentFrame_t(error);
+            frames.push_back(FragmentFrame_t(error));
         } else {
             // regular fragment
-            frame = new RegularFragmentFrame_t
-                (chain.findSubFragment(name.name));
+            frames.push_back(FragmentFrame_t(top().findSubFragment(name.name)));
         }
 
         // check for empty fragment
-        if (frame->overflown()) {
+        if (frames.back().overflown()) {
+            // get rid of frame
+            frames.pop_back();
+
             // we have to remove new context (if just created)
             if (name.context) chains.pop_back();
-
-            // get rid of frame
-            delete frame;
             return S_NO_ITERATIONS;
         }
 
         // ok we have at least one iteration
-        chain.pushFrame(name.name, frame);
+        frames.back().attachLocals(storage.localsAt(frames.size() - 1));
         return S_OK;
     }
 
-    virtual const Fragment_t *getCurrentFragment() const {
-        return chains.back().getCurrentFragment();
+    inline const Fragment_t *getCurrentFragment() const {
+        return top().getCurrentFragment();
+    }
+
+    inline const FragmentFrame_t& getCurrentFrame() const {
+        return top();
     }
 
     inline bool nextIteration() {
         // process next iteration of current fragment
-        return chains.back().nextIteration();
+        return top().nextIteration();
     }
 
-    inline Status_t popFrame() {
-        // get current chain
-        FragmentChain_t &chain = chains.back();
+    /** @short Removes current frame.
+     * @param returnAddress address where to continue after repeated
+     *                      fragment (-1 when frame was not repeated)
+     */
+    inline Status_t popFrame(int &returnAddress) {
+        // check for underflow
+        if (chainEmpty()) return S_OUT_OF_CONTEXT;
+
+        // remove last frame
+        frames.pop_back();
+        returnAddress = -1;
+
+        // leaving repeated fragment
+        if (!repeats.empty() && (repeats.back().frame == frames.size())) {
+            // remove copies of parent frames and restore chain
+            frames.erase(frames.begin() + chains.back(), frames.end());
+            chains.back() = repeats.back().chainStart;
+            returnAddress = repeats.back().returnAddress;
+            repeats.pop_back();
+            return S_OK;
+        }
 
-        // pop frame from last frame chain
-        if (Status_t s = chain.popFrame())
-            return s;
         // if chain is empty and is not first root remove it
-        if ((chains.size() > 1) && (chain.empty()))
+        if ((chains.size() > 1) && chainEmpty())
             chains.pop_back();
         return S_OK;
     }
 
-    inline Status_t findVariable(const Identifier_t &name, ParserValue_t &var)
+    inline Status_t findVariable(const Identifier_t &name, ParserValue_t &var,
+                                 const FragmentValue_t **source = 0)
         const
     {
-        // test whether we are in range
-        if (chains.size() > name.context) {
-            // get context's chain and try to find variable in it
-            return (chains.begin() + name.context)->findVariable(name, var);
-        }
+        // find frame and try to find variable in it
+        if (const FragmentFrame_t *frame = findFrame(name))
+            return frame->findVariable(name, var, source);
+
         // not found (invalid context position) => probably badly composed
         // bytecode
         return S_OUT_OF_CONTEXT;
@@ -601,11 +690,10 @@ public:
     inline Status_t setVariable(const Identifier_t &name,
                                 const ParserValue_t &var)
     {
-        // test whether we are in range
-        if (chains.size() > name.context) {
-            // get context's chain and try to set variable in it
-            return (chains.begin() + name.context)->setVariable(name, var);
-        }
+        // find frame and try to set variable in it
+        if (const FragmentFrame_t *frame = findFrame(name))
+            return const_cast<FragmentFrame_t*>(frame)
+                ->setVariable(name, var);
 
         // not found (invalid context position) => probably badly composed
         // bytecode
@@ -616,12 +704,12 @@ public:
                                     unsigned int &fragmentSize)
         const
     {
-        // test whether we are in range
-        if (chains.size() > name.context) {
-            // get context's chain and try to find variable in it
-            return (chains.begin() + name.context)->
-                getFragmentSize(name, fragmentSize);
+        // find frame and get its size
+        if (const FragmentFrame_t *frame = findFrame(name)) {
+            fragmentSize = frame->size();
+            return S_OK;
         }
+
         // not found (invalid context position) => probably badly composed
         // bytecode
         return S_OUT_OF_CONTEXT;
@@ -640,37 +728,36 @@ public:
                 return S_OK;
             }
 
-            // get context's chain and try to find variable in it
-            return (chains.begin() + name.context)->
-                getSubFragmentSize(name, fragmentSize);
+            // find subfragment by name (not present => zero size)
+            if (const FragmentFrame_t *frame = findFrame(name)) {
+                fragmentSize = frame->getSubFragmentSize(name.name);
+                return S_OK;
+            }
         }
         // not found (invalid context position) => probably badly composed
         // bytecode
         return S_OUT_OF_CONTEXT;
     }
 
-    inline Status_t getFragmentIteration(const Identifier_t &name,
-                                         unsigned int &fragmentIteration,
-                                         unsigned int *fragmentSize = 0)
-        const
-    {
-        // test whether we are in range
-        if (chains.size() > name.context) {
-            // get context's chain and try to find variable in it
-            return (chains.begin() + name.context)->
-                getFragmentIteration(name, fragmentIteration, fragmentSize);
-        }
-        // not found (invalid context position) => probably badly composed
-        // bytecode
-        return S_OUT_OF_CONTEXT;
+    /** @short Finds frame addressed by identifier.
+     * @return frame or 0 when out of context
+     */
+    inline const FragmentFrame_t* findFrame(const Identifier_t &name) const {
+        // check for range
+        if ((name.context >= chains.size())
+            || (name.depth > chainSize(name.context))) return 0;
+
+        // first frame of each chain is root
+        return name.depth
+            ? &frames[chains[name.context] + name.depth - 1] : &root;
     }
 
     inline Status_t exists(const Identifier_t &name) const {
         // test whether we are in range
         if (chains.size() > name.context) {
-            // get context's chain and try to find variable in it
-            return ((chains.begin() + name.context)->exists(name)
-                    ? S_OK : S_NOT_FOUND);
+            // find frame and test for existence
+            const FragmentFrame_t *frame = findFrame(name);
+            return ((frame && frame->exists(name)) ? S_OK : S_NOT_FOUND);
         }
         // not found (invalid context position) => probably badly composed
         // bytecode
@@ -679,31 +766,98 @@ public:
 
 
     /** Repeat fragment.
+     *
+     * Nested fragment of the same name in the (open) fragment is
+     * processed by the same code. Current chain is rebased (parent
+     * frames are copied) so repeated frame has the same depth as the
+     * original one.
      *
      * @param name of fragment to repeat
      * @param returnAddress return address
+     * @param maxDepth maximal number of nested repeats
      */
     inline Status_t repeatFragment(const Identifier_t &name,
-                                   int returnAddress)
+                                   int returnAddress, unsigned int maxDepth)
     {
-        std::cerr << "repeating " << name.name << " [" << std::hex
-             << returnAddress << "]" << std::endl;
-        return S_NO_ITERATIONS;
+        // repeated fragment must be open in current chain
+        if ((chains.size() != (name.context + 1u)) || !name.depth
+            || (name.depth > chainSize(name.context)))
+            return S_OUT_OF_CONTEXT;
+
+        // create frame for nested fragment of the same name
+        unsigned int start = chains.back();
+        FragmentFrame_t frame
+            (frames[start + name.depth - 1].findSubFragment(name.name));
+
+        // check for empty fragment
+        if (frame.overflown()) return S_NO_ITERATIONS;
+
+        // protect against runaway recursion
+        if (repeats.size() >= maxDepth) return S_TOO_DEEP;
+
+        // copy parent frames (they share local variables with originals)
+        chains.back() = frames.size();
+        for (unsigned int i = 0; (i + 1) < name.depth; ++i) {
+            FragmentFrame_t parent(frames[start + i]);
+            frames.push_back(parent);
+        }
+        frames.push_back(frame);
+        frames.back().attachLocals(storage.localsAt(frames.size() - 1));
+
+        // remember where to return
+        FragmentRepeat_t repeat;
+        repeat.frame = frames.size() - 1;
+        repeat.chainStart = start;
+        repeat.returnAddress = returnAddress;
+        repeats.push_back(repeat);
+        return S_OK;
+    }
+
+    /** @short Returns number of open fragments (in all contexts).
+     */
+    inline unsigned int getDepth() const {
+        return frames.size();
     }
 
 private:
     FragmentStack_t(const FragmentStack_t&);
     FragmentStack_t operator= (const FragmentStack_t&);
 
+    /** @short Returns whether current chain has no frame (except root).
+     */
+    inline bool chainEmpty() const {
+        return frames.size() == chains.back();
+    }
+
+    /** @short Returns number of frames (except root) in given chain.
+     */
+    inline unsigned int chainSize(unsigned int context) const {
+        return (((context + 1) < chains.size())
+                ? chains[context + 1] : frames.size()) - chains[context];
+    }
+
+    /** @short Returns top frame of current chain.
+     */
+    inline FragmentFrame_t& top() {
+        return chainEmpty() ? root : frames.back();
+    }
+
+    inline const FragmentFrame_t& top() const {
+        return chainEmpty() ? root : frames.back();
+    }
+
     const Fragment_t *data;
     Error_t &error;
     bool enableErrorFragment;
 
-    RegularFragmentFrame_t root;
-    std::vector<FragmentChain_t> chains;
+    FragmentFrame_t root;
+    FragmentStorage_t ownStorage;
+    FragmentStorage_t &storage;
+    std::vector<FragmentFrame_t> &frames;
+    std::vector<unsigned int> &chains;
+    std::vector<FragmentRepeat_t> &repeats;
 };
 
 } // namespace Teng
 
 #endif // TENGFRAGEMENTSTACK_H
-
@@ -207,7 +207,8 @@ void Instruction_t::dump(FILE *fp) const
             break;
 
         case PRINT:
-            fprintf(fp, "PRINT\n");
+            fprintf(fp, value.integerValue ? "PRINT\tpreformatted\n"
+                    : "PRINT\n");
             break;
 
         case FRAGFIRST:
@@ -259,6 +260,10 @@ void Instruction_t::dump(FILE *fp) const
             fprintf(fp, "EXISTMARK\n");
             break;
 
+        case FLUSH:
+            fprintf(fp, "FLUSH\n");
+            break;
+
         default:
             fprintf(fp, "??? (%d)\n", operation);
     }
@@ -434,7 +439,9 @@ void Instruction_t::dump(std::ostream &os, int ip) const {
         break;
 
     case PRINT:
-        os << "PRINT" << std::endl;
+        os << "PRINT";
+        if (value.integerValue) os << "           <preformatted>";
+        os << std::endl;
         break;
 
     case SET:
@@ -491,6 +498,10 @@ void Instruction_t::dump(std::ostream &os, int ip) const {
         os << "EXISTMARK" << std::endl;
         break;
 
+    case FLUSH:
+        os << "FLUSH" << std::endl;
+        break;
+
     default:
         os << "<ILLEGAL>       opcode == " << operation << std::endl;
         break;
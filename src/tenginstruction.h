@@ -47,6 +47,10 @@
 namespace Teng {
 
 struct Identifier_t {
+    Identifier_t()
+        : name(), context(0), depth(0), slot(-1)
+    {}
+
     /** @short Name of identifier.
      */
     std::string name;
@@ -67,6 +71,13 @@ struct Identifier_t {
      * distance form the root.
      */
     unsigned short int depth;
+
+    /** @short Slot of local variable in fragment frame.
+     *
+     * Local variables are resolved to slots at compile time (each
+     * fragment frame has its own slots). -1 means no local variable.
+     */
+    int slot;
 };
 
 /** Instruction for "teng computer".
@@ -127,6 +138,7 @@ struct Instruction_t {
         AT, /**< Get value at given index */
         REPR, /**< Convert frag value into value */
         EXISTMARK, /**< Marks start of exist/defined block */
+        FLUSH, /**< Flush output writer. */
     };
 
     /** Create simple instruction without params.
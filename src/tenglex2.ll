@@ -199,6 +199,12 @@ IDENT   [_[:alpha:]][_[:alnum:]]*
     RETURN(LEX_REPEATFRAG);
 }
 
+"<?teng"[[:space:]\0]+"flush" {
+    // match '<?teng flush'
+    bufferPos.advance(yytext, yyleng);
+    RETURN(LEX_FLUSH);
+}
+
 "<?teng"[[:space:]\0]*[[:alnum:]]* {
     // match '<?teng???'
     value.stringValue = std::string(yytext + 6, yyleng - 6);
@@ -302,6 +308,12 @@ IDENT   [_[:alpha:]][_[:alnum:]]*
     RETURN(LEX_REPEATFRAG);
 }
 
+"<?"[[:space:]\0]*"flush" {
+    // match '<?teng flush'
+    bufferPos.advance(yytext, yyleng);
+    RETURN(LEX_FLUSH);
+}
+
 "<?" {
     // xml tag start
     bufferPos.advanceColumn(yyleng);
@@ -87,9 +87,12 @@ Program_t* ParserContext_t::createProgramFromFile(
     // empty previous stacked values
     fragContext.clear(); // delete all fragment contexts
     fragContext.reserve(20);
+    rootSlots.clear();
 
     while (!sourceIndex.empty())
         sourceIndex.pop(); //delete all source indexes
+    while (!formatModes.empty())
+        formatModes.pop(); //delete all format modes
     while (!lex1.empty()) {
         delete lex1.top(); //delete all lex1 objects
         lex1.pop();
@@ -97,6 +100,8 @@ Program_t* ParserContext_t::createProgramFromFile(
 
     // create (empty) program
     program = new Program_t();
+    // drop compile errors below configured level
+    program->getErrors().setMinLevel(paramDictionary->getLogLevel());
 
     // create old eval processor
     delete evalProcessor;
@@ -143,6 +148,11 @@ Program_t* ParserContext_t::createProgramFromFile(
         }
     }
 
+    // remember amount of static text
+    program->computeStaticSize();
+    // remember data accessed by program
+    program->computeDataUsage();
+
     // return program
     return program;
 }
@@ -156,9 +166,12 @@ Program_t* ParserContext_t::createProgramFromString(const std::string &str)
     // empty previous stacked values
     fragContext.clear(); //delete all fragment contexts
     fragContext.reserve(20);
+    rootSlots.clear();
 
     while (!sourceIndex.empty())
         sourceIndex.pop(); //delete all source indexes
+    while (!formatModes.empty())
+        formatModes.pop(); //delete all format modes
     while (!lex1.empty()) {
         delete lex1.top(); //delete all lex1 objects
         lex1.pop();
@@ -166,6 +179,8 @@ Program_t* ParserContext_t::createProgramFromString(const std::string &str)
 
     // create (empty) program
     program = new Program_t;
+    // drop compile errors below configured level
+    program->getErrors().setMinLevel(paramDictionary->getLogLevel());
 
     // delete old eval processor
     delete evalProcessor;
@@ -202,6 +217,11 @@ Program_t* ParserContext_t::createProgramFromString(const std::string &str)
         }
     }
 
+    // remember amount of static text
+    program->computeStaticSize();
+    // remember data accessed by program
+    program->computeDataUsage();
+
     // return program
     return program;
 }
@@ -304,7 +324,6 @@ bool ParserContext_t::findFragmentForVariable(const Error_t::Position_t &pos,
                                               const IdentifierName_t &name,
                                               const std::string &fullName,
                                               Identifier_t &id)
-    const
 {
     // process all contexts and try to find varible's prefix (fragment
     // name)
@@ -320,6 +339,8 @@ bool ParserContext_t::findFragmentForVariable(const Error_t::Position_t &pos,
             id.context = (fragContext.rend() - ifragContext - 1);
             // set fragment depth
             id.depth = name.size() - 1;
+            // set slot of local variable
+            assignSlot(id);
             return true;
         }
     }
@@ -401,7 +422,6 @@ ParserContext_t::exists(const Error_t::Position_t &pos,
                         const IdentifierName_t &name,
                         const std::string &fullName, Identifier_t &id,
                         bool mustBeOpen)
-    const
 {
     // try to find fragment -- fragment's parent is sufficient
     FragmentResolution_t fr = findFragment(0, name, fullName, id, !mustBeOpen);
@@ -409,11 +429,14 @@ ParserContext_t::exists(const Error_t::Position_t &pos,
     // determine object's existence
     switch (fr) {
     case FR_FOUND:
-        // we have found fragment => exist is always true
+        // we have found fragment => exist is always true (slot is used
+        // by defined())
+        if (!id.name.empty()) assignSlot(id);
         return ER_FOUND;
     case FR_PARENT_FOUND:
         // we have found parent fragment of identifier =>
         // resolution must be made in runtime
+        assignSlot(id);
         return ER_RUNTIME;
     case FR_NOT_FOUND:
         // not found => this object couldn't exist
@@ -428,6 +451,17 @@ ParserContext_t::exists(const Error_t::Position_t &pos,
     return ER_NOT_FOUND;
 }
 
+void ParserContext_t::assignSlot(Identifier_t &id) {
+    // root fragment is shared by all contexts
+    LocalSlots_t &slots = id.depth
+        ? fragContext[id.context].slots[id.depth - 1] : rootSlots;
+
+    // use existing slot or allocate new one
+    std::pair<LocalSlots_t::iterator, bool> insertResult
+        = slots.insert(LocalSlots_t::value_type(id.name, slots.size()));
+    id.slot = insertResult.first->second;
+}
+
 int ParserContext_t::getFragmentAddress(const Error_t::Position_t &pos,
                                         const IdentifierName_t &name,
                                         const std::string &fullName,
@@ -40,6 +40,7 @@
 #include <string>
 #include <vector>
 #include <stack>
+#include <map>
 
 #include "tengdictionary.h"
 #include "tengconfiguration.h"
@@ -47,6 +48,7 @@
 #include "tenglex2.h"
 #include "tengprogram.h"
 #include "tengprocessor.h"
+#include "tengformatter.h"
 
 namespace Teng {
 
@@ -91,7 +93,7 @@ struct ParserContext_t {
     bool findFragmentForVariable(const Error_t::Position_t &pos,
                                  const IdentifierName_t &name,
                                  const std::string &fullName,
-                                 Identifier_t &id) const;
+                                 Identifier_t &id);
 
     enum FragmentResolution_t {
         FR_NOT_FOUND = 0,
@@ -114,7 +116,15 @@ struct ParserContext_t {
     ExistResolution_t exists(const Error_t::Position_t &pos,
                              const IdentifierName_t &name,
                              const std::string &fullName, Identifier_t &id,
-                             bool mustBeOpen = false) const;
+                             bool mustBeOpen = false);
+
+    /** Assign slot of local variable to the identifier (id.context
+      * and id.depth must address open fragment).
+      * @param id Identifier of variable. */
+    void assignSlot(Identifier_t &id);
+
+    /** Slots of local variables of one fragment (name -> slot). */
+    typedef std::map<std::string, int> LocalSlots_t;
 
     int getFragmentAddress(const Error_t::Position_t &pos,
                            const IdentifierName_t &name,
@@ -148,6 +158,7 @@ struct ParserContext_t {
         void reserve(unsigned int n) {
             name.reserve(n);
             addresses.reserve(n);
+            slots.reserve(n);
         }
 
         std::string fullname() const {
@@ -163,11 +174,13 @@ struct ParserContext_t {
         void push_back(const std::string &n, int a) {
             name.push_back(n);
             addresses.push_back(a);
+            slots.push_back(LocalSlots_t());
         }
 
         void pop_back() {
             name.pop_back();
             addresses.pop_back();
+            slots.pop_back();
         }
 
         bool empty() const {
@@ -186,11 +199,16 @@ struct ParserContext_t {
 
         IdentifierName_t name;
         std::vector<int> addresses;
+        std::vector<LocalSlots_t> slots;
     };
 
     /** Actual fragment context when parsing a template. */
     std::vector<FragmentContext_t> fragContext;
 
+    /** Slots of local variables of root fragment (shared by all
+      * contexts). */
+    LocalSlots_t rootSlots;
+
     /** Program created by parser.
      * Temporary value used when parsing. */
     Program_t *program;
@@ -200,6 +218,10 @@ struct ParserContext_t {
       * into the single VAL, PRINT pair. */
     unsigned int lowestValPrintAddress;
 
+    /** Formatting modes of open <?teng format ...?> blocks.
+      * Static text is pre-formatted by the mode on the top. */
+    std::stack<Formatter_t::Mode_t> formatModes;
+
     /** Processor unit used for evaluation of constant expressions. */
     Processor_t *evalProcessor;
 
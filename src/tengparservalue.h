@@ -74,6 +74,24 @@ struct ParserValue_t {
     void setReal(double val);
     /** Sets type, stringValue, intValue and realValue. */
     void setReal(double val, int prec);
+
+    /** Sets type, intValue and realValue; stringValue is given
+      * already formatted value (no conversion is done). */
+    inline void setInteger(int_t val, const std::string &str) {
+        stringValue = str;
+        integerValue = val;
+        realValue = val;
+        type = TYPE_INT;
+    }
+
+    /** Sets type, intValue and realValue; stringValue is given
+      * already formatted value (no conversion is done). */
+    inline void setReal(double val, const std::string &str) {
+        stringValue = str;
+        integerValue = (int_t)val;
+        realValue = val;
+        type = TYPE_REAL;
+    }
     /** If type==TYPE_STRING, try to convert string to a numeric value.
       * First, try to convert into real value, then integer value. */
     ParserValue_t validate() const;
@@ -91,6 +91,8 @@ class FragVal_t {
             FRAGMENT,
             FRAGMENT_LIST,
             FRAGMENT_VALUE,
+            FRAGMENT_ROW,  // row of columnar list
+            FRAGMENT_CELL, // value in columnar list
         };
 
         FragValueType type;
@@ -99,18 +101,47 @@ class FragVal_t {
             const FragmentList_t *list;
             const FragmentValue_t *value;
         };
+        unsigned int row;
+        unsigned int column;
 
         FragVal_t()
         : type(FRAGMENT_NULL) {}
 
         FragVal_t(const Fragment_t *frag)
-        : type(FRAGMENT), frag(frag) {}
+        : type(frag ? FRAGMENT : FRAGMENT_NULL), frag(frag) {}
 
         FragVal_t(const FragmentList_t *list)
         : type(FRAGMENT_LIST), list(list) {}
 
         FragVal_t(const FragmentValue_t *value)
         : type(FRAGMENT_VALUE), value(value) {}
+
+        FragVal_t(const FragmentList_t *list, unsigned int row)
+        : type(FRAGMENT_ROW), list(list), row(row) {}
+
+        FragVal_t(const FragmentList_t *list, unsigned int row,
+                  unsigned int column)
+        : type(FRAGMENT_CELL), list(list), row(row), column(column) {}
+
+        // returns fragment (or row) at given index of list
+        static FragVal_t at(const FragmentList_t *list, unsigned int index) {
+            if (list->isColumnar()) return FragVal_t(list, index);
+            return FragVal_t((*list)[index]);
+        }
+
+        // returns member of fragment (or row), null value when not found
+        static FragVal_t member(const FragVal_t &fragment,
+                                const std::string &name)
+        {
+            if (fragment.type == FRAGMENT_ROW) {
+                int column = fragment.list->findColumn(name);
+                if (column < 0) return FragVal_t();
+                return FragVal_t(fragment.list, fragment.row, column);
+            }
+            Fragment_t::const_iterator it = fragment.frag->find(name);
+            if (it == fragment.frag->end()) return FragVal_t();
+            return FragVal_t(it->second);
+        }
 };
 
 // performs UDF calls
@@ -182,14 +213,20 @@ FunctionParam_t::FunctionParam_t(Processor_t &processor,
 
 namespace {
 
+const std::string NO_SOURCE;
+
+inline const std::string& source(const Instruction_t &instr,
+                                 const Program_t &program)
+{
+    return (instr.sourceIndex < 0)
+        ? NO_SOURCE : program.getSource(instr.sourceIndex);
+}
+
 inline Error_t::Position_t position(const Instruction_t &instr,
                                     const Program_t &program)
 {
-    return Error_t::Position_t
-        (((instr.sourceIndex < 0) ? "" :
-          program.getSource(instr.sourceIndex)),
-         instr.line,
-         instr.column);
+    return Error_t::Position_t(source(instr, program), instr.line,
+                               instr.column);
 }
 
 }
@@ -197,9 +234,24 @@ inline Error_t::Position_t position(const Instruction_t &instr,
 void Processor_t::logErr(const Instruction_t &instr, const std::string &s,
                          Error_t::Level_t level)
 {
+    if (!error->isLogged(level)) return;
     error->logRuntimeError(level, position(instr, program), s);
 }
 
+void Processor_t::logErr(const Instruction_t &instr, const char *format,
+                         Error_t::Level_t level)
+{
+    error->logRuntimeError(level, source(instr, program), instr.line,
+                           instr.column, format);
+}
+
+void Processor_t::logErr(const Instruction_t &instr, const char *format,
+                         const std::string &argument, Error_t::Level_t level)
+{
+    error->logRuntimeError(level, source(instr, program), instr.line,
+                           instr.column, format, argument);
+}
+
 void Processor_t::logErrNoInstr(const std::string &s,
                                 Error_t::Level_t level)
 {
@@ -607,7 +659,36 @@ namespace {
         // dump all fragments (nestedFragments non-null)
         for (Fragment_t::const_iterator ifragment = fragment.begin();
              ifragment != fragment.end(); ++ifragment) {
-            if (ifragment->second->nestedFragments) {
+            if (ifragment->second->nestedFragments
+                && ifragment->second->nestedFragments->isColumnar()) {
+                const FragmentList_t &list = *ifragment->second->nestedFragments;
+                std::string buffer;
+                for (unsigned int k = 0; k != list.size(); ++k) {
+                    if (output.write(padding)) return -1;
+
+                    char s[20];
+                    if (output.write(ifragment->first)) return -1;
+                    sprintf(s, "[%u]: \n", k);
+                    if (output.write(escaper.escape(s))) return -1;
+
+                    for (unsigned int c = 0; c != list.getColumnCount(); ++c) {
+                        if (output.write(padding + "    ")) return -1;
+                        if (output.write(list.getColumnName(c))) return -1;
+                        if (output.write(escaper.escape(": \""))) return -1;
+
+                        // clip string to specified length
+                        std::string strVal = list.getValue(k, c, buffer);
+                        int unsigned len = configuration.getMaxDebugValLength();
+                        if (len > 0)
+                            Teng::clipString(strVal, len);
+
+                        if (output.write
+                            (escaper.escape(strVal + "\"\n")))
+                            return -1;
+                    }
+                    if (output.write(escaper.escape("\n"))) return -1;
+                }
+            } else if (ifragment->second->nestedFragments) {
                 unsigned int k = 0;
                 for (FragmentList_t::const_iterator
                          inestedFragments = ifragment->second->nestedFragments->begin();
@@ -690,11 +771,11 @@ int dumpBytecode(const Escaper_t &escaper, const Program_t &program,
 } // namespace
 
 #define WARN_IF(...)\
-    if ( existMarks == 0 )\
+    if ( existMarks == 0 && error->isLogged(Error_t::LL_WARNING) )\
         logErr(__VA_ARGS__)
 
 void Processor_t::run(const Fragment_t &data, Formatter_t &output,
-                      Error_t &inError)
+                      Error_t &inError, FragmentStorage_t *storage)
 {
     ParserValue_t a;
     FragVal_t cVal;
@@ -715,7 +796,7 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
 
     // create fragment stack
     FragmentStack_t fragmentStack
-        (&data, *error, configuration.isErrorFragmentEnabled());
+        (&data, *error, configuration.isErrorFragmentEnabled(), storage);
 
     for (;;) {
         if ((ip < 0) || (ip >= (int)program.size())) {
@@ -754,6 +835,17 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
             break;
 
         case Instruction_t::VAL:
+            // printed literal lives in the program => write it directly
+            if ((ip < (int)program.size()) &&
+                program[ip].operation == Instruction_t::PRINT) {
+                // PRINT with non-zero value marks pre-formatted text
+                if (program[ip].value.integerValue
+                    ? output.writePreformatted(instr.value.stringValue)
+                    : output.writeStatic(instr.value.stringValue))
+                    return;
+                ++ip;
+                break;
+            }
             valueStack.push(instr.value);
             break;
 
@@ -771,9 +863,8 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                 if (item == 0)
                     item = configuration.lookup(a.stringValue);
                 if (item == 0) {
-                    logErr(instr, "Dictionary item '" + a.stringValue +
-                           "' was not found",
-                           Error_t::LL_WARNING);
+                    logErr(instr, "Dictionary item '%s' was not found",
+                           a.stringValue, Error_t::LL_WARNING);
                     item = &a.stringValue;
                 }
                 a.setString(*item);
@@ -781,30 +872,32 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
             valueStack.push(a);
             break;
 
-        case Instruction_t::VAR:
-            if (fragmentStack.findVariable(instr.identifier, a)) {
-                logErr(instr, "Variable '" + instr.value.stringValue
-                       + "' is undefined",
-                       Error_t::LL_WARNING);
+        case Instruction_t::VAR: {
+            // value in data tree (0 for locals and error fragment values)
+            const FragmentValue_t *source = 0;
+            if (fragmentStack.findVariable(instr.identifier, a, &source)) {
+                logErr(instr, "Variable '%s' is undefined",
+                       instr.value.stringValue, Error_t::LL_WARNING);
                 a = ParserValue_t();
             } else {
+                bool escape = false;
                 if ( configuration.isAlwaysEscapeEnabled() ) {
                     // check whether we have to escape variable
                     // FIXME: This is bug, type should be used
-                    if (instr.value.integerValue)
-                        a.setString(fParam.escaper.escape(a.stringValue));
+                    escape = instr.value.integerValue;
                 } else {
                     // Peek next inst and escape only if PRINT follows
-                    if ( (ip < (int)program.size()) &&
-                        program[ip].operation == Instruction_t::PRINT &&
-                        instr.value.type == ParserValue_t::TYPE_STRING
-                        ) {
-                        a.setString(fParam.escaper.escape(a.stringValue));
-                    }
+                    escape = ((ip < (int)program.size()) &&
+                              program[ip].operation == Instruction_t::PRINT &&
+                              instr.value.type == ParserValue_t::TYPE_STRING);
                 }
+                // values known to need no escaping are left untouched
+                if (escape && !(source && fParam.escaper.isClean(source->value)))
+                    a.setString(fParam.escaper.escape(a.stringValue));
             }
             valueStack.push(a);
             break;
+        }
 
         case Instruction_t::PUSH:
             if (valueStack.empty()) {
@@ -923,9 +1016,8 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                         break; // OK
                     case -1:
                         if ( p != 0 ) {
-                            logErr(instr, "Bad argument count for function '"
-                                + instr.value.stringValue + "()'",
-                                Error_t::LL_ERROR);
+                            logErr(instr, "Bad argument count for function '%s()'",
+                                instr.value.stringValue, Error_t::LL_ERROR);
                         } else {
                             logErr(instr, errmsg,
                                 Error_t::LL_ERROR);
@@ -933,10 +1025,8 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                         break;
                     default:
                         if ( p != 0 ) {
-                            logErr(instr, "Function '"
-                                + instr.value.stringValue
-                                + "()' call failed",
-                                Error_t::LL_ERROR);
+                            logErr(instr, "Function '%s()' call failed",
+                                instr.value.stringValue, Error_t::LL_ERROR);
                         } else {
                             logErr(instr, errmsg,
                                 Error_t::LL_ERROR);
@@ -944,9 +1034,8 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                     }
                     valueStack.push(a);
                 } else {
-                    logErr(instr, "Call to unknown function '"
-                           + instr.value.stringValue + "()'",
-                           Error_t::LL_ERROR);
+                    logErr(instr, "Call to unknown function '%s()'",
+                           instr.value.stringValue, Error_t::LL_ERROR);
                     a.setString("unknown");
                     valueStack.push(a);
                 }
@@ -1020,6 +1109,10 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                            Error_t::LL_FATAL);
                     goto flushReturn;
                 }
+            } else if (configuration.isFlushOnFragEnabled()
+                       && (fragmentStack.getDepth() == 1)) {
+                // send so far generated output before outermost fragment
+                if (output.flushWriter()) return;
             }
             break;
 
@@ -1035,16 +1128,31 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                 }
             } else {
                 // no more iterations, we have to pop frame
-                if (fragmentStack.popFrame()) {
+                int returnAddress;
+                if (fragmentStack.popFrame(returnAddress)) {
                     logErr(instr, "Fragment stack underflow",
                            Error_t::LL_FATAL);
                     goto flushReturn;
                 }
+
+                // end of repeated fragment => return after repeat
+                if (returnAddress >= 0) {
+                    ip = returnAddress;
+                    if (ip >= (int)program.size()) {
+                        logErr(instr, "Repeat fragment return address "
+                               "points out of program address space",
+                               Error_t::LL_FATAL);
+                        goto flushReturn;
+                    }
+                }
             }
             break;
 
         case Instruction_t::REPEATFRAG:
-            if (!fragmentStack.repeatFragment(instr.identifier, ip)) {
+            switch (fragmentStack.repeatFragment
+                    (instr.identifier, ip,
+                     configuration.getMaxRepeatDepth())) {
+            case S_OK:
                 // OK some iteratiion -> jump to the fragment
                 ip += instr.value.integerValue;
                 if ((ip < 0) || (ip >= (int)program.size())) {
@@ -1053,6 +1161,20 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                            Error_t::LL_FATAL);
                     goto flushReturn;
                 }
+                break;
+            case S_NO_ITERATIONS:
+                // no nested fragment => nothing to repeat
+                break;
+            case S_TOO_DEEP:
+                // protect against runaway recursion
+                logErr(instr, "Fragment '%s' is repeated too deep; "
+                       "repeat ignored", instr.value.stringValue,
+                       Error_t::LL_ERROR);
+                break;
+            default:
+                logErr(instr, "Fragment '%s' is not open, cannot repeat it",
+                       instr.value.stringValue, Error_t::LL_ERROR);
+                break;
             }
             break;
 
@@ -1061,9 +1183,8 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                 unsigned int fragmentSize = 0;
                 if (fragmentStack.getFragmentSize(instr.identifier,
                                                   fragmentSize)) {
-                    logErr(instr, "Fragment '" + instr.value.stringValue
-                           + "' doesn't exist, cannot determine its size.",
-                           Error_t::LL_WARNING);
+                    logErr(instr, "Fragment '%s' doesn't exist, cannot determine its size.",
+                           instr.value.stringValue, Error_t::LL_WARNING);
                 }
                 a.setInteger(fragmentSize);
                 valueStack.push(a);
@@ -1076,9 +1197,8 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                 unsigned int fragmentSize = 0;
                 if (fragmentStack.getSubFragmentSize(instr.identifier,
                                                      fragmentSize)) {
-                    logErr(instr, "Fragment '" + instr.value.stringValue
-                           + "' doesn't exist, cannot determine its size.",
-                           Error_t::LL_WARNING);
+                    logErr(instr, "Fragment '%s' doesn't exist, cannot determine its size.",
+                           instr.value.stringValue, Error_t::LL_WARNING);
                 }
                 a.setInteger(fragmentSize);
                 valueStack.push(a);
@@ -1086,67 +1206,54 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
             break;
 
         case Instruction_t::FRAGITR:
-            {
-                unsigned int fragmentIteration = 0;
-                if (fragmentStack.getFragmentIteration(instr.identifier,
-                                                       fragmentIteration)) {
-                    logErr(instr, "Fragment '" + instr.value.stringValue
-                           + "' not open, cannot determine current iteration.",
-                           Error_t::LL_WARNING);
-                }
-                a.setInteger(fragmentIteration);
-                valueStack.push(a);
+            if (const FragmentFrame_t *frame
+                = fragmentStack.findFrame(instr.identifier)) {
+                a.setInteger(frame->iteration());
+            } else {
+                logErr(instr, "Fragment '%s' not open, cannot determine current iteration.",
+                       instr.value.stringValue, Error_t::LL_WARNING);
+                a.setInteger(0);
             }
+            valueStack.push(a);
             break;
 
         case Instruction_t::FRAGFIRST:
-            {
-                unsigned int fragmentIteration = 0;
-                if (fragmentStack.getFragmentIteration(instr.identifier,
-                                                       fragmentIteration)) {
-                    logErr(instr, "Fragment '" + instr.value.stringValue
-                           + "' not open, cannot determine whether "
-                           "we are in first iteration.",
-                           Error_t::LL_WARNING);
-                }
-                a.setInteger(!fragmentIteration);
-                valueStack.push(a);
+            if (const FragmentFrame_t *frame
+                = fragmentStack.findFrame(instr.identifier)) {
+                a.setInteger(frame->isFirst());
+            } else {
+                logErr(instr, "Fragment '%s' not open, cannot determine whether "
+                       "we are in first iteration.",
+                       instr.value.stringValue, Error_t::LL_WARNING);
+                a.setInteger(true);
             }
+            valueStack.push(a);
             break;
 
         case Instruction_t::FRAGLAST:
-            {
-                unsigned int fragmentIteration = 0;
-                unsigned int fragmentSize = 0;
-                if (fragmentStack.getFragmentIteration(instr.identifier,
-                                                       fragmentIteration,
-                                                       &fragmentSize)) {
-                    logErr(instr, "Fragment '" + instr.value.stringValue
-                           + "' not open, cannot determine whether "
-                           "we are in the last iteration.",
-                           Error_t::LL_WARNING);
-                }
-                a.setInteger(fragmentIteration == (fragmentSize - 1));
-                valueStack.push(a);
+            if (const FragmentFrame_t *frame
+                = fragmentStack.findFrame(instr.identifier)) {
+                a.setInteger(frame->isLast());
+            } else {
+                logErr(instr, "Fragment '%s' not open, cannot determine whether "
+                       "we are in the last iteration.",
+                       instr.value.stringValue, Error_t::LL_WARNING);
+                a.setInteger(false);
             }
+            valueStack.push(a);
             break;
 
         case Instruction_t::FRAGINNER:
-            {
-                unsigned int fragmentIteration = 0;
-                unsigned int fragmentSize = 0;
-                if (fragmentStack.getFragmentIteration(instr.identifier,
-                                                       fragmentIteration,
-                                                       &fragmentSize)) {
-                    logErr(instr, "Fragment '" + instr.value.stringValue
-                           + "' not open, cannot determine whether "
-                           "we are in an inner iteration.",
-                           Error_t::LL_WARNING);
-                }
-                a.setInteger(fragmentIteration &&
-                             (fragmentIteration < (fragmentSize - 1)));
-                valueStack.push(a);
+            if (const FragmentFrame_t *frame
+                = fragmentStack.findFrame(instr.identifier)) {
+                a.setInteger(frame->isInner());
+            } else {
+                logErr(instr, "Fragment '%s' not open, cannot determine whether "
+                       "we are in an inner iteration.",
+                       instr.value.stringValue, Error_t::LL_WARNING);
+                a.setInteger(false);
             }
+            valueStack.push(a);
             break;
 
         case Instruction_t::PRINT:
@@ -1177,15 +1284,13 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                 break;
             case S_ALREADY_DEFINED:
                 logErr(instr,
-                       "Cannot rewrite variable '" + instr.value.stringValue
-                       + "' which is already set by the application.",
-                       Error_t::LL_WARNING);
+                       "Cannot rewrite variable '%s' which is already set "
+                       "by the application.",
+                       instr.value.stringValue, Error_t::LL_WARNING);
                 break;
             default:
-                logErr(instr,
-                       "Cannot set variable '" + instr.value.stringValue
-                       + "'.",
-                       Error_t::LL_WARNING);
+                logErr(instr, "Cannot set variable '%s'.",
+                       instr.value.stringValue, Error_t::LL_WARNING);
                 break;
             }
             break;
@@ -1206,6 +1311,10 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
             existMarks++;
             break;
 
+        case Instruction_t::FLUSH:
+            if (output.flushWriter()) return;
+            break;
+
         case Instruction_t::AT:
             if (valueStack.empty()) {
                 logErr(instr, "Value stack underflow",
@@ -1225,26 +1334,21 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
             if ( cVal.type != FragVal_t::FRAGMENT_NULL ) {
                 if ( a.type == ParserValue_t::TYPE_STRING ) {
                     const std::string &member = a.stringValue;
-                    if ( cVal.type == FragVal_t::FRAGMENT ) {
-                        Fragment_t::const_iterator it = cVal.frag->find(member);
-                        if ( it == cVal.frag->end() ) {
-                            WARN_IF(instr, "Unable to locate member (1) '" + member + "'",
-                                Error_t::LL_WARNING);
-                            cVal = FragVal_t();
-                        } else {
-                            cVal = FragVal_t(it->second);
+                    if ( cVal.type == FragVal_t::FRAGMENT
+                         || cVal.type == FragVal_t::FRAGMENT_ROW ) {
+                        cVal = FragVal_t::member(cVal, member);
+                        if ( cVal.type == FragVal_t::FRAGMENT_NULL ) {
+                            WARN_IF(instr, "Unable to locate member (1) '%s'",
+                                member, Error_t::LL_WARNING);
                         }
                     } else if ( cVal.type == FragVal_t::FRAGMENT_VALUE && cVal.value->nestedFragments != 0 ) {
                         const FragmentList_t *nested = cVal.value->nestedFragments;
                         if ( nested->size() == 1 ) {
-                            Fragment_t *frag = (*nested)[0];
-                            Fragment_t::const_iterator it = frag->find(member);
-                            if ( it == frag->end() ) {
-                                WARN_IF(instr, "Unable to locate member (2) '" + member + "'",
-                                    Error_t::LL_WARNING);
-                                cVal = FragVal_t();
-                            } else {
-                                cVal = FragVal_t(it->second);
+                            cVal = FragVal_t::member(FragVal_t::at(nested, 0),
+                                                     member);
+                            if ( cVal.type == FragVal_t::FRAGMENT_NULL ) {
+                                WARN_IF(instr, "Unable to locate member (2) '%s'",
+                                    member, Error_t::LL_WARNING);
                             }
                         } else {
                             WARN_IF(instr, "String indices can be used only for fragments",
@@ -1257,20 +1361,22 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                 } else if ( a.type == ParserValue_t::TYPE_INT ) {
                     if ( cVal.type == FragVal_t::FRAGMENT_LIST ) {
                         if ( a.integerValue < 0 || static_cast<size_t>(a.integerValue) >= cVal.list->size() ) {
-                            WARN_IF(instr, "Index " + FragmentValue_t(a.integerValue).value +
-                                " is out of range", Error_t::LL_WARNING);
+                            WARN_IF(instr, "Index %s is out of range",
+                                FragmentValue_t(a.integerValue).value,
+                                Error_t::LL_WARNING);
                             cVal = FragVal_t();
                         } else {
-                            cVal = FragVal_t((*cVal.list)[a.integerValue]);
+                            cVal = FragVal_t::at(cVal.list, a.integerValue);
                         }
                     } else if ( cVal.type == FragVal_t::FRAGMENT_VALUE && cVal.value->nestedFragments != 0 ) {
                         const FragmentList_t *nested = cVal.value->nestedFragments;
                         if ( a.integerValue < 0 || static_cast<size_t>(a.integerValue) >= nested->size() ) {
-                            WARN_IF(instr, "Index " + FragmentValue_t(a.integerValue).value +
-                                " is out of range", Error_t::LL_WARNING);
+                            WARN_IF(instr, "Index %s is out of range",
+                                FragmentValue_t(a.integerValue).value,
+                                Error_t::LL_WARNING);
                             cVal = FragVal_t();
                         } else {
-                            cVal = FragVal_t((*nested)[a.integerValue]);
+                            cVal = FragVal_t::at(nested, a.integerValue);
                         }
                     } else {
                         WARN_IF(instr, "Only fragment lists can be indexed",
@@ -1290,7 +1396,11 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
             if ( instr.value.stringValue == "@(root)" ) {
                 fragmentValueStack.push(FragVal_t(&data));
             } else if ( instr.value.stringValue == "@(this)" ) {
-                fragmentValueStack.push(FragVal_t(fragmentStack.getCurrentFragment()));
+                const FragmentFrame_t &frame = fragmentStack.getCurrentFrame();
+                if (const FragmentList_t *list = frame.getColumnarList())
+                    fragmentValueStack.push(FragVal_t(list, frame.iteration()));
+                else
+                    fragmentValueStack.push(FragVal_t(frame.getCurrentFragment()));
             } else {
                 if (fragmentValueStack.empty()) {
                     logErr(instr, "Fragment value stack underflow",
@@ -1302,40 +1412,41 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                 cVal = fragmentValueStack.top();
                 fragmentValueStack.pop();
 
-                if ( cVal.type == FragVal_t::FRAGMENT ) {
-                    Fragment_t::const_iterator it = cVal.frag->find(member);
-                    if ( it == cVal.frag->end() ) {
-                        WARN_IF(instr, "Unable to locate member (3) '" + member + "'",
-                            Error_t::LL_WARNING);
-                        cVal = FragVal_t();
-                    } else {
-                        cVal = FragVal_t(it->second);
+                if ( cVal.type == FragVal_t::FRAGMENT
+                     || cVal.type == FragVal_t::FRAGMENT_ROW ) {
+                    cVal = FragVal_t::member(cVal, member);
+                    if ( cVal.type == FragVal_t::FRAGMENT_NULL ) {
+                        WARN_IF(instr, "Unable to locate member (3) '%s'",
+                            member, Error_t::LL_WARNING);
                     }
+                } else if ( cVal.type == FragVal_t::FRAGMENT_CELL ) {
+                    WARN_IF(instr, "Unable to locate member (4) '%s'"
+                        " in value",
+                        member, Error_t::LL_WARNING);
+                    cVal = FragVal_t();
                 } else if ( cVal.type == FragVal_t::FRAGMENT_VALUE ) {
                     if ( cVal.value->nestedFragments == 0 ) {
-                        WARN_IF(instr, "Unable to locate member (4) '" + member + "'"
+                        WARN_IF(instr, "Unable to locate member (4) '%s'"
                             " in value",
-                            Error_t::LL_WARNING);
+                            member, Error_t::LL_WARNING);
                         cVal = FragVal_t();
                     } else {
-                        if ( cVal.value->nestedFragments->size() == 1 ) {
-                            const Fragment_t *frag = (*cVal.value->nestedFragments)[0];
-                            Fragment_t::const_iterator it = frag->find(member);
-                            if ( it == frag->end() ) {
-                                WARN_IF(instr, "Unable to locate member (5) '" + member + "'",
-                                    Error_t::LL_WARNING);
-                                cVal = FragVal_t();
-                            } else {
-                                cVal = FragVal_t(it->second);
+                        const FragmentList_t *nested = cVal.value->nestedFragments;
+                        if ( nested->size() == 1 ) {
+                            cVal = FragVal_t::member(FragVal_t::at(nested, 0),
+                                                     member);
+                            if ( cVal.type == FragVal_t::FRAGMENT_NULL ) {
+                                WARN_IF(instr, "Unable to locate member (5) '%s'",
+                                    member, Error_t::LL_WARNING);
                             }
                         } else {
                             cVal = FragVal_t(cVal.value->nestedFragments);
                         }
                     }
                 } else if ( cVal.type != FragVal_t::FRAGMENT_NULL ) {
-                    WARN_IF(instr, "Unable to locate member (6) '" + member + "'"
+                    WARN_IF(instr, "Unable to locate member (6) '%s'"
                         " in fragment list",
-                        Error_t::LL_WARNING);
+                        member, Error_t::LL_WARNING);
                     cVal = FragVal_t();
                 }
                 fragmentValueStack.push(cVal);
@@ -1364,6 +1475,15 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                     case FragVal_t::FRAGMENT_VALUE:
                         cVal.value->json(os);
                         break;
+                    case FragVal_t::FRAGMENT_ROW:
+                        cVal.list->json(os, cVal.row);
+                        break;
+                    case FragVal_t::FRAGMENT_CELL: {
+                        std::string buffer;
+                        os << '"' << cVal.list->getValue(cVal.row, cVal.column,
+                                                         buffer) << '"';
+                        break;
+                    }
                     default:
                         break;
                 }
@@ -1371,9 +1491,14 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
             } else if ( instr.value.stringValue == "type" ) {
                 switch ( cVal.type ) {
                     case FragVal_t::FRAGMENT:
+                    case FragVal_t::FRAGMENT_ROW:
                         a.setString("frag");
                         break;
 
+                    case FragVal_t::FRAGMENT_CELL:
+                        a.setString("value");
+                        break;
+
                     case FragVal_t::FRAGMENT_LIST:
                         a.setString("list");
                         break;
@@ -1392,6 +1517,8 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
             } else if ( instr.value.stringValue == "count" ) {
                 switch ( cVal.type ) {
                     case FragVal_t::FRAGMENT:
+                    case FragVal_t::FRAGMENT_ROW:
+                    case FragVal_t::FRAGMENT_CELL:
                         a.setInteger(1);
                         break;
 
@@ -1416,6 +1543,8 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                     case FragVal_t::FRAGMENT:
                     case FragVal_t::FRAGMENT_LIST:
                     case FragVal_t::FRAGMENT_VALUE:
+                    case FragVal_t::FRAGMENT_ROW:
+                    case FragVal_t::FRAGMENT_CELL:
                         a.setInteger(1);
                         break;
 
@@ -1430,9 +1559,34 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                         break;
 
                     case FragVal_t::FRAGMENT:
+                    case FragVal_t::FRAGMENT_ROW:
                         a.setString("$frag$");
                         break;
 
+                    case FragVal_t::FRAGMENT_CELL: {
+                        std::string buffer;
+                        const std::string &value
+                            = cVal.list->getValue(cVal.row, cVal.column,
+                                                  buffer);
+                        // formatted numbers need no escaping
+                        switch (cVal.list->getColumnType(cVal.column)) {
+                        case FragmentList_t::COLUMN_INT:
+                            a.setInteger(cVal.list->getInteger(cVal.row,
+                                                               cVal.column),
+                                         value);
+                            break;
+                        case FragmentList_t::COLUMN_REAL:
+                            a.setReal(cVal.list->getReal(cVal.row,
+                                                         cVal.column),
+                                      value);
+                            break;
+                        default:
+                            a.setString(fParam.escaper.escape(value));
+                            break;
+                        }
+                        break;
+                    }
+
                     case FragVal_t::FRAGMENT_LIST:
                         a.setString("$fraglist$");
                         break;
@@ -1440,6 +1594,15 @@ void Processor_t::run(const Fragment_t &data, Formatter_t &output,
                     case FragVal_t::FRAGMENT_VALUE:
                         if ( cVal.value->nestedFragments != 0 )
                             a.setString("$fraglist$");
+                        // formatted numbers need no escaping
+                        else if (cVal.value->type == FragmentValue_t::TYPE_INT)
+                            a.setInteger(cVal.value->integerValue,
+                                         cVal.value->value);
+                        else if (cVal.value->type == FragmentValue_t::TYPE_REAL)
+                            a.setReal(cVal.value->realValue,
+                                      cVal.value->value);
+                        else if (fParam.escaper.isClean(cVal.value->value))
+                            a.setString(cVal.value->value);
                         else
                             a.setString(fParam.escaper.escape(cVal.value->value));
                         break;
@@ -1571,6 +1734,24 @@ int Processor_t::eval(ParserValue_t &result, int startAddress,
             valueStack.push(a);
             break;
 
+        case Instruction_t::DICT:
+            // dictionaries are part of program's cache key, so lookup
+            // of constant key can be done at compile time
+            if (valueStack.empty()) return -1;
+            a = valueStack.top();
+            valueStack.pop();
+            {
+                const std::string *item;
+                item = langDictionary.lookup(a.stringValue);
+                if (item == 0)
+                    item = configuration.lookup(a.stringValue);
+                // missing item is left for runtime (reports warning)
+                if (item == 0) return -1;
+                a.setString(*item);
+            }
+            valueStack.push(a);
+            break;
+
         case Instruction_t::FUNC:
             {
                 ParserValue_t::int_t i = instr.value.integerValue;
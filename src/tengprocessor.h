@@ -57,6 +57,8 @@
 
 namespace Teng {
 
+class FragmentStorage_t;
+
 class Processor_t {
 public:
 
@@ -74,9 +76,10 @@ public:
     /** Execute program.
      * @param data Application data supplied bu user.
      * @param writer Output stream object.
-     * @param error Error log object. */
+     * @param error Error log object.
+     * @param storage Reusable storage for fragment frames (or 0). */
     void run(const Fragment_t &data, Formatter_t &writer,
-             Error_t &error);
+             Error_t &error, FragmentStorage_t *storage = 0);
 
     /** Try to evaluate an expression.
      * @return 0=ok (expression evaluated), -1=error (cannot evaluate).
@@ -128,6 +131,19 @@ private:
     void logErr(const Instruction_t &instr, const std::string &s,
                 Error_t::Level_t level);
 
+    /** Logs runtime error, message is formatted when log is read
+     * @param instr on which instruction
+     * @param format static error message */
+    void logErr(const Instruction_t &instr, const char *format,
+                Error_t::Level_t level);
+
+    /** Logs runtime error, message is formatted when log is read
+     * @param instr on which instruction
+     * @param format static error message, "%s" is replaced by argument
+     * @param argument argument of format */
+    void logErr(const Instruction_t &instr, const char *format,
+                const std::string &argument, Error_t::Level_t level);
+
 
     /** Logs runtime error where no instruction available
      * @param s error message */
@@ -35,6 +35,9 @@
  */
 
 #include <cstdio>
+#include <vector>
+#include <string>
+#include <utility>
 
 #include "tengprogram.h"
 
@@ -50,5 +53,100 @@ void Program_t::dump(FILE *fp) const {
     }
 }
 
+void Program_t::computeStaticSize() {
+    staticSize = 0;
+    // sum lengths of values printed immediately
+    for (const_iterator i = begin(); i != end(); ++i) {
+        if ((i->operation == Instruction_t::VAL) && ((i + 1) != end())
+            && ((i + 1)->operation == Instruction_t::PRINT))
+            staticSize += i->value.stringValue.length();
+    }
+}
+
+void Program_t::computeDataUsage() {
+    dataUsage.clear();
+
+    // paths of open fragments (code of fragments is nested)
+    std::vector<std::string> fragments(1, std::string());
+    // paths of $$ expressions being evaluated (index may hold another)
+    std::vector<std::pair<std::string, bool> > chains;
+
+    for (const_iterator i = begin(); i != end(); ++i) {
+        const std::string &path = i->value.stringValue;
+        switch (i->operation) {
+        case Instruction_t::VAR:
+            dataUsage.add(path, DataUsage_t::US_VARIABLE);
+            break;
+
+        case Instruction_t::DEFINED:
+            dataUsage.add(path, DataUsage_t::US_VARIABLE
+                          | DataUsage_t::US_EXIST);
+            break;
+
+        case Instruction_t::EXIST:
+            dataUsage.add(path, DataUsage_t::US_EXIST);
+            break;
+
+        case Instruction_t::FRAG:
+            dataUsage.add(path, DataUsage_t::US_FRAGMENT);
+            fragments.push_back(path);
+            break;
+
+        case Instruction_t::ENDFRAG:
+            if (fragments.size() > 1) fragments.pop_back();
+            break;
+
+        case Instruction_t::FRAGCNT:
+        case Instruction_t::XFRAGCNT:
+        case Instruction_t::FRAGITR:
+        case Instruction_t::FRAGFIRST:
+        case Instruction_t::FRAGLAST:
+        case Instruction_t::FRAGINNER:
+            dataUsage.add(path, DataUsage_t::US_FRAGMENT);
+            break;
+
+        case Instruction_t::REPEATFRAG:
+            // repeated code runs on any nested fragment of current one
+            dataUsage.add(fragments.back(), DataUsage_t::US_FRAGMENT
+                          | DataUsage_t::US_SUBTREE);
+            break;
+
+        case Instruction_t::DEBUGING:
+            dataUsage.addEverything();
+            break;
+
+        case Instruction_t::GETATTR:
+            if (path == "@(root)") {
+                chains.push_back(std::make_pair(std::string(), false));
+            } else if (path == "@(this)") {
+                chains.push_back(std::make_pair(fragments.back(), false));
+            } else if (!chains.empty() && !chains.back().second) {
+                chains.back().first += "." + path;
+            }
+            break;
+
+        case Instruction_t::AT:
+            // index may be member name -- anything below can be read
+            if (!chains.empty()) chains.back().second = true;
+            break;
+
+        case Instruction_t::REPR:
+            if (!chains.empty()) {
+                unsigned int usage = DataUsage_t::US_VARIABLE;
+                if (chains.back().second || (path == "json"))
+                    usage |= DataUsage_t::US_SUBTREE;
+                else if (path == "exists")
+                    usage = DataUsage_t::US_EXIST;
+                dataUsage.add(chains.back().first, usage);
+                chains.pop_back();
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
 } // namespace Teng
 
@@ -43,6 +43,7 @@
 #include "tenginstruction.h"
 #include "tengsourcelist.h"
 #include "tengerror.h"
+#include "tengdatausage.h"
 
 namespace Teng {
 
@@ -53,7 +54,7 @@ public:
 
     /** @short Create new program. */
     Program_t()
-        : sources(), error()
+        : sources(), error(), staticSize(0), dataUsage()
     {}
 
     /** Print whole program into file stream.
@@ -89,7 +90,7 @@ public:
     /** Get source's filename based on index in source list.
       * @return Absolute filename string.
       * @param position Index into program's source list. */
-    inline std::string getSource(unsigned int position) const {
+    inline const std::string& getSource(unsigned int position) const {
         return sources.getSource(position);
     }
 
@@ -97,6 +98,26 @@ public:
         return sources;
     }
 
+    /** @short Compute size of static text printed by the program.
+      * Called when program is complete. */
+    void computeStaticSize();
+
+    /** @short Return size of static text printed by the program.
+      * @return Sum of lengths of printed literals. */
+    inline unsigned int getStaticSize() const {
+        return staticSize;
+    }
+
+    /** @short Compute data paths the program can access.
+      * Called when program is complete. */
+    void computeDataUsage();
+
+    /** @short Return data paths the program can access.
+      * @return Data usage computed by computeDataUsage(). */
+    inline const DataUsage_t& getDataUsage() const {
+        return dataUsage;
+    }
+
     using std::vector<Instruction_t>::empty;
 
     using std::vector<Instruction_t>::begin;
@@ -124,6 +145,12 @@ private:
 
     /** @short Error logger. */
     Error_t error;
+
+    /** @short Size of static text printed by the program. */
+    unsigned int staticSize;
+
+    /** @short Data paths the program can access. */
+    DataUsage_t dataUsage;
 };
 
 } // namespace Teng
@@ -105,6 +105,17 @@ unsigned int SourceList_t::addSource(const std::string &_source,
     return sources.size() - 1;
 }
 
+void SourceList_t::append(const SourceList_t &other) {
+    for (std::vector<FileStat_t>::const_iterator
+             iother = other.sources.begin();
+         iother != other.sources.end(); ++iother) {
+        // skip already present entries
+        if (std::find(sources.begin(), sources.end(), *iother)
+            == sources.end())
+            sources.push_back(*iother);
+    }
+}
+
 bool SourceList_t::isChanged() const {
     Error_t err;
     Error_t::Position_t pos;
@@ -123,10 +134,11 @@ bool SourceList_t::isChanged() const {
     return false;
 }
 
-std::string SourceList_t::getSource(unsigned int position) const {
+const std::string& SourceList_t::getSource(unsigned int position) const {
+    static const std::string empty;
     if (position < sources.size())
         return sources[position].filename;
-    return std::string();
+    return empty;
 }
 
 } // namespace Teng
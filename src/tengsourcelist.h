@@ -167,12 +167,19 @@ public:
      */
     bool isChanged() const;
 
+    /** @short Adds all sources from other list (with their cached
+     *         stat data).
+     *
+     * @param other source list
+     */
+    void append(const SourceList_t &other);
+
     /** @short Get source by given index.
      *
      * @param position index in the source list
      * @return filename or empty string on error
      */
-    std::string getSource(unsigned int position) const;
+    const std::string& getSource(unsigned int position) const;
 
     inline unsigned int size() const {
         return sources.size();
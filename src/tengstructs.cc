@@ -37,30 +37,67 @@
 */
 
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <sstream>
+#include <map>
+#include <stdexcept>
 
 #include "tengstructs.h"
 #include "tengplatform.h"
 
 namespace Teng {
 
+namespace {
+
+void formatInteger(IntType_t value, std::string &result) {
+    std::ostringstream os;
+    os << value;
+    result = os.str();
+}
+
+void formatReal(double value, std::string &result) {
+    char buff[64];
+
+    // print value to the buffer
+    int len = snprintf(buff, sizeof(buff), "%f", value);
+    // find dot in the buffer
+    if (!strchr(buff, '.')) {
+        // no dot => append ".0"
+        result = std::string(buff, len);
+        result.append(".0");
+    } else {
+        // dot found => find first nonzero character from the right
+        for (char *c = buff + len - 1;
+             ((*(c - 1) != '.') && (*c == '0'));
+             --len, --c);
+        // create string
+        result = std::string(buff, len);
+    }
+}
+
+} // namespace
+
 FragmentValue_t::FragmentValue_t()
-    : value(), nestedFragments(0)
+    : value(), nestedFragments(0),
+      type(TYPE_STRING), integerValue(0), realValue(0.0), used(true)
 {}
 
 FragmentValue_t::FragmentValue_t(const std::string &value)
-    : value(value), nestedFragments(0)
+    : value(value), nestedFragments(0),
+      type(TYPE_STRING), integerValue(0), realValue(0.0), used(true)
 {}
 
 FragmentValue_t::FragmentValue_t(IntType_t value_)
-    : nestedFragments(0)
+    : nestedFragments(0),
+      type(TYPE_STRING), integerValue(0), realValue(0.0), used(true)
 {
     setValue(value_);
 }
 
 FragmentValue_t::FragmentValue_t(double value_)
-    : nestedFragments(0)
+    : nestedFragments(0),
+      type(TYPE_STRING), integerValue(0), realValue(0.0), used(true)
 {
     setValue(value_);
 }
@@ -73,6 +110,7 @@ void FragmentValue_t::setValue(const std::string &value_) {
     }
 
     value = value_;
+    type = TYPE_STRING;
 }
 
 void FragmentValue_t::setValue(const IntType_t value_) {
@@ -82,9 +120,11 @@ void FragmentValue_t::setValue(const IntType_t value_) {
         nestedFragments = 0;
     }
 
-    std::ostringstream os;
-    os << value_;
-    value = os.str();
+    formatInteger(value_, value);
+    // keep native value
+    type = TYPE_INT;
+    integerValue = value_;
+    realValue = value_;
 }
 
 void FragmentValue_t::setValue(const double value_) {
@@ -94,32 +134,73 @@ void FragmentValue_t::setValue(const double value_) {
         nestedFragments = 0;
     }
 
-    char buff[64];
+    formatReal(value_, value);
+    // keep native value
+    type = TYPE_REAL;
+    integerValue = static_cast<IntType_t>(value_);
+    realValue = value_;
+}
 
-    // print value to the buffer
-    int len = snprintf(buff, sizeof(buff), "%f", value_);
-    // find dot in the buffer
-    if (!strchr(buff, '.')) {
-        // no dot => append ".0"
-        value = std::string(buff, len);
-        value.append(".0");
-    } else {
-        // dot found => find first nonzero character from the right
-        for (char *c = buff + len - 1;
-             ((*(c - 1) != '.') && (*c == '0'));
-             --len, --c);
-        // create string
-        value = std::string(buff, len);
+void FragmentValue_t::swapValue(std::string &value_) {
+    // get rid of nested fragments if exist
+    if (nestedFragments) {
+        delete nestedFragments;
+        nestedFragments = 0;
     }
+
+    value.swap(value_);
+    type = TYPE_STRING;
 }
 
 FragmentValue_t::~FragmentValue_t() {
     delete nestedFragments;
 }
 
+void FragmentValue_t::reset() {
+    used = false;
+    // keep string's buffer and nested list for reuse
+    value.erase();
+    type = TYPE_STRING;
+    if (nestedFragments) nestedFragments->reset();
+}
+
 Fragment_t::~Fragment_t() {
-    for (iterator i = begin(); i != end(); ++i)
+    // do not use begin()/end() -- they would run the generator
+    for (iterator i = std::map<std::string, FragmentValue_t*>::begin();
+         i != std::map<std::string, FragmentValue_t*>::end(); ++i)
+        delete i->second;
+}
+
+void Fragment_t::reset() {
+    generator = 0;
+    // keep values (and their names) used since last reset for reuse,
+    // drop the others so the fragment does not grow without bound
+    for (iterator i = std::map<std::string, FragmentValue_t*>::begin();
+         i != std::map<std::string, FragmentValue_t*>::end(); ) {
+        if (i->second->used) {
+            i->second->reset();
+            ++i;
+        } else {
+            delete i->second;
+            erase(i++);
+        }
+    }
+}
+
+void Fragment_t::clear() {
+    generator = 0;
+    for (iterator i = std::map<std::string, FragmentValue_t*>::begin();
+         i != std::map<std::string, FragmentValue_t*>::end(); ++i)
         delete i->second;
+    std::map<std::string, FragmentValue_t*>::clear();
+}
+
+void Fragment_t::generate() const {
+    // forget generator first, generator may access the fragment
+    FragmentGenerator_t *g = generator;
+    generator = 0;
+    // content is generated on read access of otherwise const data
+    g->generate(const_cast<Fragment_t&>(*this));
 }
 
 void Fragment_t::addVariable(const std::string &name, const std::string &value) {
@@ -132,8 +213,9 @@ void Fragment_t::addVariable(const std::string &name, const std::string &value)
         // succeeded, replace by value
         v = new FragmentValue_t(value);
     } else {
-         // already present => destroy and create new
+         // already present (or unused) => destroy and create new
         v->setValue(value);
+        v->used = true;
     }
 }
 
@@ -147,8 +229,9 @@ void Fragment_t::addVariable(const std::string &name, IntType_t value) {
         // succeeded, replace by value
         v = new FragmentValue_t(value);
     } else {
-        // already present => destroy and create new
+        // already present (or unused) => destroy and create new
         v->setValue(value);
+        v->used = true;
     }
 }
 
@@ -162,11 +245,50 @@ void Fragment_t::addVariable(const std::string &name, double value) {
         // succeeded, replace by value
         v = new FragmentValue_t(value);
     } else {
-         // already present => destroy and create new
+         // already present (or unused) => destroy and create new
         v->setValue(value);
+        v->used = true;
     }
 }
 
+FragmentValue_t& Fragment_t::scalarValue(const std::string &name) {
+    // insert dummy zero
+    std::pair<iterator, bool> inserted(insert(value_type(name, 0)));
+
+    FragmentValue_t *&v = inserted.first->second;
+
+    if (inserted.second) {
+        // succeeded, replace by empty value
+        v = new FragmentValue_t();
+    } else {
+        // already present (or unused) => clear it (keeps buffer)
+        v->setValue(std::string());
+        v->used = true;
+    }
+    return *v;
+}
+
+void Fragment_t::swapVariable(const std::string &name, std::string &value) {
+    // insert dummy zero
+    std::pair<iterator, bool> inserted(insert(value_type(name, 0)));
+
+    FragmentValue_t *&v = inserted.first->second;
+
+    if (inserted.second) {
+        // succeeded, replace by empty value
+        v = new FragmentValue_t();
+    } else {
+        // already present (or unused, i.e. empty) => caller gets its
+        // content
+        v->used = true;
+    }
+    v->swapValue(value);
+}
+
+std::string& Fragment_t::emplaceVariable(const std::string &name) {
+    return scalarValue(name).value;
+}
+
 Fragment_t& Fragment_t::addFragment(const std::string &name) {
     return addFragmentList(name).addFragment();
 }
@@ -183,11 +305,13 @@ Fragment_t::addFragmentList(const std::string &name) {
         v = new FragmentValue_t();
         v->nestedFragments = new FragmentList_t();
     } else {
-        // already present
+        // already present (unused list has been reset)
+        v->used = true;
 
         // get rid of scalar value and create an empty fragment list if scalar
         if (!v->nestedFragments) {
             v->value.erase();
+            v->type = FragmentValue_t::TYPE_STRING;
             v->nestedFragments = new FragmentList_t();
         }
     }
@@ -202,14 +326,252 @@ Fragment_t& FragmentValue_t::addFragment() {
     return nestedFragments->addFragment();
 }
 
+/**
+ * @short Columns of columnar fragment list.
+ */
+struct FragmentList_t::Columns_t {
+    /**
+     * @short Single column, only vector of column's type is used.
+     */
+    struct Column_t {
+        std::string name;
+        ColumnType_t type;
+        std::vector<std::string> strings;
+        std::vector<IntType_t> integers;
+        std::vector<double> reals;
+    };
+
+    std::vector<Column_t> columns;
+    std::map<std::string, unsigned int> index;
+};
+
 FragmentList_t::~FragmentList_t() {
     for (iterator i = begin(); i != end(); ++i)
         delete *i;
+    for (iterator i = spare.begin(); i != spare.end(); ++i)
+        delete *i;
+    delete columns;
+}
+
+void FragmentList_t::reset() {
+    // drop spare fragments not reused since last reset
+    for (iterator i = spare.begin(); i != spare.end(); ++i)
+        delete *i;
+    spare.clear();
+
+    // keep fragments for reuse
+    spare.reserve(std::vector<Fragment_t*>::size());
+    for (iterator i = begin(); i != end(); ++i) {
+        (*i)->reset();
+        spare.push_back(*i);
+    }
+    std::vector<Fragment_t*>::clear();
+
+    // keep columns, strings are reused by addRow()
+    if (columns) {
+        for (std::vector<Columns_t::Column_t>::iterator
+                 icolumns = columns->columns.begin();
+             icolumns != columns->columns.end(); ++icolumns) {
+            icolumns->integers.clear();
+            icolumns->reals.clear();
+        }
+    }
+    rows = 0;
+}
+
+void FragmentList_t::clear() {
+    for (iterator i = begin(); i != end(); ++i)
+        delete *i;
+    std::vector<Fragment_t*>::clear();
+    for (iterator i = spare.begin(); i != spare.end(); ++i)
+        delete *i;
+    spare.clear();
+    delete columns;
+    columns = 0;
+    rows = 0;
+}
+
+int FragmentList_t::addColumn(const std::string &name, ColumnType_t type) {
+    // list of fragments cannot be columnar
+    if (!std::vector<Fragment_t*>::empty()) return -1;
+    if (!columns) columns = new Columns_t();
+
+    // register column name
+    std::pair<std::map<std::string, unsigned int>::iterator, bool> inserted
+        = columns->index.insert(std::make_pair(name,
+                                               columns->columns.size()));
+    if (!inserted.second)
+        return (columns->columns[inserted.first->second].type == type)
+            ? int(inserted.first->second) : -1;
+
+    // create column with default values for existing rows
+    columns->columns.push_back(Columns_t::Column_t());
+    Columns_t::Column_t &column = columns->columns.back();
+    column.name = name;
+    column.type = type;
+    switch (type) {
+    case COLUMN_STRING:
+        column.strings.resize(rows);
+        break;
+    case COLUMN_INT:
+        column.integers.resize(rows);
+        break;
+    case COLUMN_REAL:
+        column.reals.resize(rows);
+        break;
+    }
+    return inserted.first->second;
+}
+
+unsigned int FragmentList_t::addRow() {
+    // rows are defined by columns
+    if (!columns)
+        throw std::logic_error("FragmentList_t::addRow(): list has no "
+                               "columns");
+
+    // add default value to all columns
+    for (std::vector<Columns_t::Column_t>::iterator
+             icolumns = columns->columns.begin();
+         icolumns != columns->columns.end(); ++icolumns) {
+        switch (icolumns->type) {
+        case COLUMN_STRING:
+            // reuse string kept by reset()
+            if (icolumns->strings.size() > rows)
+                icolumns->strings[rows].erase();
+            else icolumns->strings.push_back(std::string());
+            break;
+        case COLUMN_INT:
+            icolumns->integers.push_back(0);
+            break;
+        case COLUMN_REAL:
+            icolumns->reals.push_back(0.0);
+            break;
+        }
+    }
+    return rows++;
+}
+
+void FragmentList_t::setValue(unsigned int row, unsigned int column,
+                              const std::string &value)
+{
+    Columns_t::Column_t &c = columns->columns[column];
+    switch (c.type) {
+    case COLUMN_STRING:
+        c.strings[row] = value;
+        break;
+    case COLUMN_INT:
+        c.integers[row] = strtol(value.c_str(), 0, 10);
+        break;
+    case COLUMN_REAL:
+        c.reals[row] = strtod(value.c_str(), 0);
+        break;
+    }
+}
+
+void FragmentList_t::setValue(unsigned int row, unsigned int column,
+                              IntType_t value)
+{
+    Columns_t::Column_t &c = columns->columns[column];
+    switch (c.type) {
+    case COLUMN_STRING:
+        formatInteger(value, c.strings[row]);
+        break;
+    case COLUMN_INT:
+        c.integers[row] = value;
+        break;
+    case COLUMN_REAL:
+        c.reals[row] = value;
+        break;
+    }
+}
+
+void FragmentList_t::setValue(unsigned int row, unsigned int column,
+                              double value)
+{
+    Columns_t::Column_t &c = columns->columns[column];
+    switch (c.type) {
+    case COLUMN_STRING:
+        formatReal(value, c.strings[row]);
+        break;
+    case COLUMN_INT:
+        c.integers[row] = static_cast<IntType_t>(value);
+        break;
+    case COLUMN_REAL:
+        c.reals[row] = value;
+        break;
+    }
+}
+
+void FragmentList_t::swapValue(unsigned int row, unsigned int column,
+                               std::string &value)
+{
+    Columns_t::Column_t &c = columns->columns[column];
+    if (c.type == COLUMN_STRING) c.strings[row].swap(value);
+    else setValue(row, column, value);
+}
+
+int FragmentList_t::findColumn(const std::string &name) const {
+    if (!columns) return -1;
+    std::map<std::string, unsigned int>::const_iterator fcolumn
+        = columns->index.find(name);
+    return (fcolumn == columns->index.end()) ? -1 : int(fcolumn->second);
+}
+
+unsigned int FragmentList_t::getColumnCount() const {
+    return columns ? columns->columns.size() : 0;
+}
+
+const std::string& FragmentList_t::getColumnName(unsigned int column) const {
+    return columns->columns[column].name;
+}
+
+const std::string& FragmentList_t::getValue(unsigned int row,
+                                            unsigned int column,
+                                            std::string &buffer) const
+{
+    const Columns_t::Column_t &c = columns->columns[column];
+    switch (c.type) {
+    case COLUMN_STRING:
+        return c.strings[row];
+    case COLUMN_INT:
+        formatInteger(c.integers[row], buffer);
+        break;
+    case COLUMN_REAL:
+        formatReal(c.reals[row], buffer);
+        break;
+    }
+    return buffer;
+}
+
+FragmentList_t::ColumnType_t
+FragmentList_t::getColumnType(unsigned int column) const {
+    return columns->columns[column].type;
+}
+
+IntType_t FragmentList_t::getInteger(unsigned int row,
+                                     unsigned int column) const
+{
+    return columns->columns[column].integers[row];
+}
+
+double FragmentList_t::getReal(unsigned int row, unsigned int column) const {
+    return columns->columns[column].reals[row];
 }
 
 Fragment_t& FragmentList_t::addFragment() {
-    // add new (empty) fragment
-    push_back(new Fragment_t());
+    // columnar list cannot contain fragments
+    if (columns)
+        throw std::logic_error("FragmentList_t::addFragment(): list is "
+                               "columnar");
+
+    if (!spare.empty()) {
+        // reuse fragment kept by reset()
+        push_back(spare.back());
+        spare.pop_back();
+    } else {
+        // add new (empty) fragment
+        push_back(new Fragment_t());
+    }
     // return it
     return *back();
 }
@@ -229,24 +591,64 @@ void FragmentValue_t::dump(std::ostream &o) const {
 
 void FragmentList_t::json(std::ostream &o) const {
     o << '[';
-    // dump all fragments
-    for (const_iterator i = begin(); i != end(); ++i) {
-        if (i != begin()) o << ", ";
-        (*i)->json(o);
+    if (columns) {
+        // dump all rows
+        for (unsigned int row = 0; row != rows; ++row) {
+            if (row) o << ", ";
+            json(o, row);
+        }
+    } else {
+        // dump all fragments
+        for (const_iterator i = begin(); i != end(); ++i) {
+            if (i != begin()) o << ", ";
+            (*i)->json(o);
+        }
     }
     o << ']';
 }
 
 void FragmentList_t::dump(std::ostream &o) const {
     o << '[';
-    // dump all fragments
-    for (const_iterator i = begin(); i != end(); ++i) {
-        if (i != begin()) o << ", ";
-        (*i)->dump(o);
+    if (columns) {
+        // dump all rows
+        for (unsigned int row = 0; row != rows; ++row) {
+            if (row) o << ", ";
+            dump(o, row);
+        }
+    } else {
+        // dump all fragments
+        for (const_iterator i = begin(); i != end(); ++i) {
+            if (i != begin()) o << ", ";
+            (*i)->dump(o);
+        }
     }
     o << ']';
 }
 
+void FragmentList_t::json(std::ostream &o, unsigned int row) const {
+    std::string buffer;
+    o << '{';
+    // dump all columns
+    for (unsigned int column = 0; column != getColumnCount(); ++column) {
+        if (column) o << ", ";
+        o << "\"" << getColumnName(column) << "\" : \""
+          << getValue(row, column, buffer) << '"';
+    }
+    o << '}';
+}
+
+void FragmentList_t::dump(std::ostream &o, unsigned int row) const {
+    std::string buffer;
+    o << '{';
+    // dump all columns
+    for (unsigned int column = 0; column != getColumnCount(); ++column) {
+        if (column) o << ", ";
+        o << "'" << getColumnName(column) << "': '"
+          << getValue(row, column, buffer) << '\'';
+    }
+    o << '}';
+}
+
 
 void Fragment_t::json(std::ostream &o) const {
     o << '{';
@@ -50,6 +50,30 @@ namespace Teng {
 
 class FragmentValue_t;
 class FragmentList_t;
+class Fragment_t;
+
+/**
+ * @short Callback producing content of lazy fragment.
+ *
+ * Generator is not owned by fragment and must live until the fragment
+ * is destroyed or generated.
+ */
+class FragmentGenerator_t {
+public:
+    virtual ~FragmentGenerator_t() {}
+
+    /**
+     * @short Fill fragment with its variables and nested fragments.
+     *
+     * Called at most once, when the fragment content is accessed
+     * for the first time (e.g. when the template reads a variable
+     * from it).
+     *
+     * @param fragment fragment to fill
+     * @return 0 OK !0 error (content added so far is kept)
+     */
+    virtual int generate(Fragment_t &fragment) = 0;
+};
 
 /**
  * @short Single fragment. Maps names to variables and nested
@@ -58,11 +82,92 @@ class FragmentList_t;
 class Fragment_t : private std::map<std::string, FragmentValue_t*> {
 public:
     Fragment_t()
-        : std::map<std::string, FragmentValue_t*>()
+        : std::map<std::string, FragmentValue_t*>(), generator(0)
     {}
 
     ~Fragment_t();
 
+    /**
+     * @short Iterator over (name, value) pairs of fragment; skips
+     *        values unused since last reset().
+     */
+    class const_iterator {
+    public:
+        typedef std::map<std::string, FragmentValue_t*>::const_iterator
+            Base_t;
+
+        inline const_iterator()
+            : i(), e()
+        {}
+
+        inline const_iterator(Base_t i, Base_t e)
+            : i(i), e(e)
+        {
+            skip();
+        }
+
+        inline const value_type& operator*() const {
+            return *i;
+        }
+
+        inline const value_type* operator->() const {
+            return &*i;
+        }
+
+        inline const_iterator& operator++() {
+            ++i;
+            skip();
+            return *this;
+        }
+
+        inline const_iterator operator++(int) {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        inline bool operator==(const const_iterator &other) const {
+            return i == other.i;
+        }
+
+        inline bool operator!=(const const_iterator &other) const {
+            return i != other.i;
+        }
+
+    private:
+        inline void skip();
+
+        Base_t i; //!< current position
+        Base_t e; //!< end of map
+    };
+
+    /**
+     * @short Make fragment lazy: its content will be generated by
+     *        given generator on first access.
+     *
+     * @param generator content generator (not owned; 0 disables)
+     */
+    inline void setGenerator(FragmentGenerator_t *generator) {
+        this->generator = generator;
+    }
+
+    /**
+     * @short Remove all variables and nested fragments but keep their
+     *        memory for reuse by following add* calls.
+     *
+     * Names are kept in fragment (as unused), so filling the fragment
+     * with data of the same shape as before allocates nothing. Names
+     * not used since previous reset() are removed. Generator is
+     * forgotten.
+     */
+    void reset();
+
+    /**
+     * @short Remove all variables and nested fragments and free their
+     *        memory (including names kept by reset()).
+     */
+    void clear();
+
     /**
      * @short Add variable to fragment.
      * @param name variable name
@@ -79,11 +184,41 @@ public:
 
     /**
      * @short Add variable to fragment.
+     *
+     * Value is printed with at most six decimal places but expressions
+     * compute with the native value (1e-7 prints as 0.0 while
+     * ${$x * 10000000} gives 1.0).
+     *
      * @param name variable name
      * @param value variable value
      */
     void addVariable(const std::string &name, double value);
 
+    /**
+     * @short Add variable to fragment without copying its value.
+     *
+     * Value is swapped into the fragment; given string gets previous
+     * content and buffer of variable (empty for new variable or
+     * variable unused since reset()).
+     *
+     * @param name variable name
+     * @param value variable value
+     */
+    void swapVariable(const std::string &name, std::string &value);
+
+    /**
+     * @short Add empty variable to fragment and return its value to
+     *        be filled in place.
+     *
+     * Existing variable is emptied (its buffer is reused).
+     *
+     * Value must not be modified once the page generation started.
+     *
+     * @param name variable name
+     * @return value of variable
+     */
+    std::string& emplaceVariable(const std::string &name);
+
     /**
      * @short Add nested fragment.
      * @param name fragment name
@@ -110,13 +245,19 @@ public:
      */
     void json(std::ostream &o) const;
 
-    using std::map<std::string, FragmentValue_t*>::begin;
+    inline const_iterator begin() const {
+        if (generator) generate();
+        return const_iterator(std::map<std::string, FragmentValue_t*>::begin(),
+                              std::map<std::string, FragmentValue_t*>::end());
+    }
 
-    using std::map<std::string, FragmentValue_t*>::end;
+    inline const_iterator end() const {
+        if (generator) generate();
+        return const_iterator(std::map<std::string, FragmentValue_t*>::end(),
+                              std::map<std::string, FragmentValue_t*>::end());
+    }
 
-    using std::map<std::string, FragmentValue_t*>::find;
-
-    using std::map<std::string, FragmentValue_t*>::const_iterator;
+    inline const_iterator find(const std::string &name) const;
 
 private:
     /**
@@ -130,15 +271,46 @@ private:
      *        disabled.
      */
     Fragment_t operator=(const Fragment_t&);
+
+    /**
+     * @short Get scalar value of given name with empty value (created
+     *        or reused).
+     * @param name variable name
+     * @return value
+     */
+    FragmentValue_t& scalarValue(const std::string &name);
+
+    /**
+     * @short Run generator of lazy fragment (and forget it).
+     */
+    void generate() const;
+
+    /**
+     * @short Generator of content not run yet (0 when none).
+     */
+    mutable FragmentGenerator_t *generator;
 };
 
 /**
  * @short List of fragments of same name at same level.
+ *
+ * List is either list of fragments or columnar list: rows of scalar
+ * variables of the same names stored in one typed vector per column
+ * (much less memory for large homogeneous lists).
  */
 class FragmentList_t : private std::vector<Fragment_t*> {
 public:
+    /**
+     * @short Type of values in column of columnar list.
+     */
+    enum ColumnType_t {
+        COLUMN_STRING, //!< string values
+        COLUMN_INT,    //!< integer values
+        COLUMN_REAL    //!< real values
+    };
+
     inline FragmentList_t()
-        : std::vector<Fragment_t*>()
+        : std::vector<Fragment_t*>(), columns(0), rows(0)
     {}
 
     /**
@@ -148,10 +320,162 @@ public:
 
     /**
      * @short Add given or empty fragment to fragment list.
+     *
+     * Must not be used on columnar list (throws std::logic_error).
+     *
      * @return created fragment
      */
     Fragment_t& addFragment();
 
+    /**
+     * @short Remove all fragments (rows) but keep their memory for
+     *        reuse by following addFragment()/addRow() calls.
+     *
+     * Columns of columnar list are kept, i.e. list stays columnar
+     * (use clear() to get plain list). Fragments not reused since
+     * previous reset() are freed.
+     */
+    void reset();
+
+    /**
+     * @short Remove all fragments and columns and free their memory.
+     */
+    void clear();
+
+    /**
+     * @short Add column to the list (list becomes columnar).
+     *
+     * Existing rows get default (empty/zero) value.
+     *
+     * @param name column (variable) name
+     * @param type type of column values
+     * @return index of column (of existing one when column of the same
+     *         name and type exists) or -1 when list contains fragments
+     *         or column of the same name has different type
+     */
+    int addColumn(const std::string &name, ColumnType_t type = COLUMN_STRING);
+
+    /**
+     * @short Add row with default (empty/zero) values to columnar list.
+     *
+     * At least one column must be added first (throws std::logic_error
+     * otherwise).
+     *
+     * @return index of created row
+     */
+    unsigned int addRow();
+
+    /**
+     * @short Set value in columnar list (converted to column type).
+     * @param row index of row
+     * @param column index of column
+     * @param value new value
+     */
+    void setValue(unsigned int row, unsigned int column,
+                  const std::string &value);
+
+    /**
+     * @short Set value in columnar list (converted to column type).
+     * @param row index of row
+     * @param column index of column
+     * @param value new value
+     */
+    void setValue(unsigned int row, unsigned int column, IntType_t value);
+
+    /**
+     * @short Set value in columnar list (converted to column type).
+     *
+     * Printed and computed as Fragment_t::addVariable(name, double).
+     *
+     * @param row index of row
+     * @param column index of column
+     * @param value new value
+     */
+    void setValue(unsigned int row, unsigned int column, double value);
+
+    /**
+     * @short Set value in columnar list without copying it (string
+     *        column) or convert it to column type.
+     *
+     * Given string gets previous value of string column.
+     *
+     * @param row index of row
+     * @param column index of column
+     * @param value new value
+     */
+    void swapValue(unsigned int row, unsigned int column,
+                   std::string &value);
+
+    /**
+     * @short Tell whether list is columnar.
+     */
+    inline bool isColumnar() const {
+        return columns;
+    }
+
+    /**
+     * @short Find column of columnar list.
+     * @param name column name
+     * @return index of column or -1 when not found
+     */
+    int findColumn(const std::string &name) const;
+
+    /**
+     * @short Number of columns of columnar list.
+     */
+    unsigned int getColumnCount() const;
+
+    /**
+     * @short Name of column of columnar list.
+     * @param column index of column
+     */
+    const std::string& getColumnName(unsigned int column) const;
+
+    /**
+     * @short Get value from columnar list as string (numbers are
+     *        formatted as in FragmentValue_t).
+     * @param row index of row
+     * @param column index of column
+     * @param buffer buffer for formatted number
+     * @return value (string in list or buffer)
+     */
+    const std::string& getValue(unsigned int row, unsigned int column,
+                                std::string &buffer) const;
+
+    /**
+     * @short Type of column of columnar list.
+     * @param column index of column
+     */
+    ColumnType_t getColumnType(unsigned int column) const;
+
+    /**
+     * @short Get value from integer column of columnar list.
+     * @param row index of row
+     * @param column index of column
+     */
+    IntType_t getInteger(unsigned int row, unsigned int column) const;
+
+    /**
+     * @short Get value from real column of columnar list.
+     * @param row index of row
+     * @param column index of column
+     */
+    double getReal(unsigned int row, unsigned int column) const;
+
+    /**
+     * @short Number of fragments (rows of columnar list).
+     */
+    inline size_type size() const {
+        return columns ? rows : std::vector<Fragment_t*>::size();
+    }
+
+    /**
+     * @short Tell whether list has no fragments (rows).
+     */
+    inline bool empty() const {
+        return !size();
+    }
+
     /**
      * @short Dump fragment list to stream.
      * @param o output stream
@@ -164,19 +488,33 @@ public:
      */
     void json(std::ostream &o) const;
 
-    using std::vector<Fragment_t*>::begin;
+    /**
+     * @short Dump row of columnar list to stream in json format
+     * @param o output stream
+     * @param row index of row
+     */
+    void json(std::ostream &o, unsigned int row) const;
 
-    using std::vector<Fragment_t*>::end;
+    /**
+     * @short Dump row of columnar list to stream.
+     * @param o output stream
+     * @param row index of row
+     */
+    void dump(std::ostream &o, unsigned int row) const;
 
-    using std::vector<Fragment_t*>::size;
+    using std::vector<Fragment_t*>::begin;
 
-    using std::vector<Fragment_t*>::empty;
+    using std::vector<Fragment_t*>::end;
 
     using std::vector<Fragment_t*>::operator [];
 
     using std::vector<Fragment_t*>::const_iterator;
 
+    using std::vector<Fragment_t*>::size_type;
+
 private:
+    struct Columns_t;
+
     /**
      * @short Copy constructor intentionally private -- copying
      *        disabled.
@@ -188,6 +526,21 @@ private:
      *        disabled.
      */
     FragmentList_t operator=(const FragmentList_t&);
+
+    /**
+     * @short Columns of columnar list (0 for list of fragments).
+     */
+    Columns_t *columns;
+
+    /**
+     * @short Number of rows of columnar list.
+     */
+    unsigned int rows;
+
+    /**
+     * @short Fragments removed by reset() ready for reuse.
+     */
+    std::vector<Fragment_t*> spare;
 };
 
 /**
@@ -197,6 +550,15 @@ private:
  */
 class FragmentValue_t {
 public:
+    /**
+     * @short Native type of scalar value.
+     */
+    enum Type_t {
+        TYPE_STRING, //!< only 'value' is valid
+        TYPE_INT,    //!< 'integerValue' holds the value
+        TYPE_REAL    //!< 'realValue' holds the value
+    };
+
     /**
      * @short Create new empty value.
      */
@@ -231,6 +593,20 @@ public:
 
     void setValue(const double value);
 
+    /**
+     * @short Set value without copying it.
+     *
+     * Given string gets previous value.
+     *
+     * @param value new value
+     */
+    void swapValue(std::string &value);
+
+    /**
+     * @short Make value unused (see Fragment_t::reset()).
+     */
+    void reset();
+
     /**
      * @short Adds new empty fragment to the frament list.
      * @return new fragment
@@ -252,6 +628,9 @@ public:
     /**
      * @short String (scalar) value.
      * Meaningles if nestedFragments non-null.
+     *
+     * Numbers are kept formatted here too; type must be TYPE_STRING
+     * when value is modified directly.
      */
     std::string value;
 
@@ -260,6 +639,26 @@ public:
      */
     FragmentList_t *nestedFragments;
 
+    /**
+     * @short Native type of scalar value (set by setValue()).
+     */
+    Type_t type;
+
+    /**
+     * @short Integer value (for TYPE_INT and TYPE_REAL).
+     */
+    IntType_t integerValue;
+
+    /**
+     * @short Real value (for TYPE_INT and TYPE_REAL).
+     */
+    double realValue;
+
+    /**
+     * @short Value is set (false after reset() until set again).
+     */
+    bool used;
+
 private:
     /**
      * @short Copy constructor intentionally private -- copying
@@ -274,6 +673,22 @@ private:
     FragmentValue_t operator=(const FragmentValue_t&);
 };
 
+inline void Fragment_t::const_iterator::skip() {
+    while ((i != e) && !i->second->used) ++i;
+}
+
+inline Fragment_t::const_iterator
+Fragment_t::find(const std::string &name) const {
+    if (generator) generate();
+    std::map<std::string, FragmentValue_t*>::const_iterator ffragment
+        = std::map<std::string, FragmentValue_t*>::find(name);
+    if ((ffragment != std::map<std::string, FragmentValue_t*>::end())
+        && !ffragment->second->used)
+        ffragment = std::map<std::string, FragmentValue_t*>::end();
+    return const_iterator(ffragment,
+                          std::map<std::string, FragmentValue_t*>::end());
+}
+
 } // namespace Teng
 
 #endif // TENGSTRUCTS_H
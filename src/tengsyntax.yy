@@ -354,6 +354,7 @@ static inline void codeForVariable(void *context,
 %token LEX_CTYPE
 %token LEX_ENDCTYPE
 %token LEX_REPEATFRAG
+%token LEX_FLUSH
 
 // assignment
 %token LEX_ASSIGN
@@ -456,6 +457,7 @@ teng_directive:
     | teng_dict
     | teng_ctype
     | teng_repeatfrag
+    | teng_flush
     ;
 
 
@@ -484,6 +486,14 @@ teng_bytecode:
     ;
 
 
+teng_flush:
+    LEX_FLUSH no_options_LEX_END
+        {
+            CODE(FLUSH); //send so far generated output to the client
+        }
+    ;
+
+
 no_options_LEX_END:
     options LEX_END
         {
@@ -596,15 +606,21 @@ teng_format:
                             + "' of 'space' formatting option");
                 }
                 // if not err, generate code
-                if ($$.val.integerValue >= 0)
+                if ($$.val.integerValue >= 0) {
                     CODE_VAL(FORM, $$.val);
+                    // remember mode for pre-formatting of static text
+                    CONTEXT->formatModes.push
+                        ((Formatter_t::Mode_t)$$.val.integerValue);
+                }
             }
         }
     template LEX_ENDFORMAT no_options_LEX_END
         {
             // if was not error no block start
-            if ($4.val.integerValue >= 0)
+            if ($4.val.integerValue >= 0) {
                 CODE(ENDFORM); //generate code
+                CONTEXT->formatModes.pop();
+            }
             // do not optimize (join) print-vals across current prog end-addr
             CONTEXT->lowestValPrintAddress = CONTEXT->program->size();
         }
@@ -2376,6 +2392,8 @@ static void printUnexpectedElement(ParserContext_t *context,
             msg = "directive '<?teng endctype'"; break;
         case LEX_REPEATFRAG:
             msg = "directive '<?teng repeat'"; break;
+        case LEX_FLUSH:
+            msg = "directive '<?teng flush'"; break;
 
         // assignment
         case LEX_ASSIGN:
@@ -46,6 +46,21 @@ Template_t::~Template_t() {
     }
 }
 
+unsigned long int Template_t::getOutputSizeEstimate() const {
+    unsigned long int estimate = owner ? owner->getEstimate(program) : 0;
+    return estimate ? estimate : program->getStaticSize();
+}
+
+void Template_t::updateOutputSizeEstimate(unsigned long int size) {
+    if (!owner) return;
+
+    // exponentially weighted moving average (alpha = 1/4)
+    unsigned long int estimate = owner->getEstimate(program);
+    if (!estimate) estimate = size;
+    else estimate = estimate - (estimate >> 2) + (size >> 2);
+    owner->setEstimate(program, estimate);
+}
+
 TemplateCache_t::TemplateCache_t(const std::string &root,
                                  const FilesystemInterface_t *filesystem,
                                  unsigned int programCacheSize,
@@ -63,13 +78,19 @@ TemplateCache_t::TemplateCache_t(const std::string &root,
       configCache(new ConfigurationCache_t
                 (dictCacheSize
                  ? dictCacheSize
-                 : ConfigurationCache_t::DEFAULT_MAXIMAL_SIZE))
+                 : ConfigurationCache_t::DEFAULT_MAXIMAL_SIZE)),
+      includeCache(new DictionaryCache_t
+                (dictCacheSize
+                 ? dictCacheSize
+                 : DictionaryCache_t::DEFAULT_MAXIMAL_SIZE))
 {}
 
 TemplateCache_t::~TemplateCache_t() {
     delete programCache;
     delete dictCache;
     delete configCache;
+    // dictionaries hold references to included ones
+    delete includeCache;
 }
 
 Template_t*
@@ -160,7 +181,7 @@ TemplateCache_t::getConfigAndDict(const std::string &configFilename,
     if (!cachedDict || (dictDependSerial != configSerial)
         || (cachedConfig->isWatchFilesEnabled() && cachedDict->check())) {
         // not found or changed -> create new dictionary
-        Dictionary_t *dict = new Dictionary_t(root);
+        Dictionary_t *dict = new Dictionary_t(root, includeCache);
         // parse file
         if (!dictFilename.empty()) dict->parse(filesystem, dictFilename);
         // add dictionary to cache and return it
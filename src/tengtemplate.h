@@ -89,6 +89,16 @@ public:
      */
     ~Template_t();
 
+    /** @short Return expected size of page generated by program.
+     *  @return running estimate or static size if program was not run
+     */
+    unsigned long int getOutputSizeEstimate() const;
+
+    /** @short Account size of generated page into the estimate.
+     *  @param size size of page generated by program
+     */
+    void updateOutputSizeEstimate(unsigned long int size);
+
     /** @short Byte compiled program.
      */
     const Program_t *program;
@@ -156,6 +166,24 @@ public:
         return getConfigAndDict(configFilename, dictFilename).second;
     }
 
+    /** @short Return size estimate kept for program.
+     *  @param program cached program
+     *  @return estimate or 0 when unknown
+     */
+    inline unsigned long int getEstimate(const Program_t *program) const {
+        return programCache->getEstimate(program);
+    }
+
+    /** @short Set size estimate kept for program.
+     *  @param program cached program
+     *  @param estimate new estimate
+     */
+    inline void setEstimate(const Program_t *program,
+                            unsigned long int estimate)
+    {
+        programCache->setEstimate(program, estimate);
+    }
+
     /** @short Release program.
      *  @param program released program
      *  @return 0 OK, !0 error
@@ -225,6 +253,11 @@ private:
     /** @short Cache of dictionaries.
      */
     ConfigurationCache_t *configCache;
+
+    /** @short Cache of included dictionaries shared by all
+     *         dictionaries in dictCache.
+     */
+    DictionaryCache_t *includeCache;
 };
 
 } // namespace Teng
@@ -154,6 +154,24 @@ namespace {
                     }
                 }
 
+                const FragmentList_t &list = *i->second->nestedFragments;
+                if (list.isColumnar()) {
+                    // rows of columnar list share column names
+                    for (unsigned int c = 0; c != list.getColumnCount(); ++c) {
+                        const std::string &column = list.getColumnName(c);
+                        if (!dataDefinition.lookup(path + "." + i->first
+                                                   + "." + column)) {
+                            error.logError(Error_t::LL_WARNING,
+                                           Error_t::Position_t(),
+                                           "Variable '" + path + "."
+                                           + i->first + "." + column +
+                                           "' is not present in data "
+                                           "definition");
+                        }
+                    }
+                    continue;
+                }
+
                 for (FragmentList_t::const_iterator
                          inf = i->second->nestedFragments->begin();
                      inf != i->second->nestedFragments->end();
@@ -35,6 +35,11 @@
  */
 
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
 #include "tengwriter.h"
 
 namespace Teng {
@@ -64,6 +69,73 @@ write(const std::string &str,
     return 0;
 }
 
+void StringWriter_t::reserve(std::string::size_type size)
+{
+    str.reserve(str.length() + size);
+}
+
+
+SegmentedWriter_t::SegmentedWriter_t(unsigned int segmentSize)
+    : segments(),
+      segmentSize(segmentSize ? segmentSize : DEFAULT_SEGMENT_SIZE),
+      length(0)
+{}
+
+int SegmentedWriter_t::write(const std::string &str)
+{
+    return append(str.data(), str.length());
+}
+
+int SegmentedWriter_t::write(const char *str)
+{
+    return append(str, strlen(str));
+}
+
+int SegmentedWriter_t::
+write(const std::string &str,
+      std::pair<std::string::const_iterator, std::string::const_iterator> interval)
+{
+    const char *cstr = str.data() + distance(str.begin(), interval.first);
+    return append(cstr, distance(interval.first, interval.second));
+}
+
+int SegmentedWriter_t::append(const char *data, std::string::size_type size)
+{
+    length += size;
+    while (size) {
+        // start new segment when the last one is full
+        if (segments.empty()
+            || (segments.back().length() >= segmentSize)) {
+            segments.push_back(std::string());
+            segments.back().reserve(segmentSize);
+        }
+        // fill the last segment
+        std::string &segment = segments.back();
+        std::string::size_type chunk = segmentSize - segment.length();
+        if (chunk > size) chunk = size;
+        segment.append(data, chunk);
+        data += chunk;
+        size -= chunk;
+    }
+    return 0;
+}
+
+std::string SegmentedWriter_t::str() const
+{
+    std::string result;
+    result.reserve(length);
+    for (Segments_t::const_iterator isegments = segments.begin();
+         isegments != segments.end(); ++isegments)
+        result.append(*isegments);
+    return result;
+}
+
+void SegmentedWriter_t::clear()
+{
+    segments.clear();
+    length = 0;
+}
+
 
 FileWriter_t::FileWriter_t(const std::string &filename)
     : Writer_t(), file(0), borrowed(false)
@@ -132,5 +204,165 @@ int FileWriter_t::flush() {
     return (fflush(file) ? -1 : 0);
 }
 
+namespace {
+    /** @short Maximal number of output vectors passed to writev.
+     */
+    const size_t MAX_VECTORS = 64;
+}
+
+BufferedFdWriter_t::BufferedFdWriter_t(const std::string &filename,
+                                       unsigned int chunkSize,
+                                       unsigned int staticThreshold)
+    : Writer_t(), fd(-1), borrowed(false),
+      staticThreshold(staticThreshold),
+      chunk(chunkSize ? chunkSize : DEFAULT_CHUNK_SIZE),
+      used(0), unlisted(0), pending(0), vectors()
+{
+    fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0)
+        err.logSyscallError(Error_t::LL_FATAL, Error_t::Position_t(),
+                            "Cannot open file '" + filename + "'");
+    vectors.reserve(MAX_VECTORS);
+}
+
+BufferedFdWriter_t::BufferedFdWriter_t(int fd, unsigned int chunkSize,
+                                       unsigned int staticThreshold)
+    : Writer_t(), fd(fd), borrowed(true),
+      staticThreshold(staticThreshold),
+      chunk(chunkSize ? chunkSize : DEFAULT_CHUNK_SIZE),
+      used(0), unlisted(0), pending(0), vectors()
+{
+    if (fd < 0)
+        err.logSyscallError(Error_t::LL_FATAL, Error_t::Position_t(),
+                            "Got invalid file descriptor");
+    vectors.reserve(MAX_VECTORS);
+}
+
+BufferedFdWriter_t::~BufferedFdWriter_t() {
+    flush();
+    if (!borrowed && (fd >= 0))
+        close(fd);
+}
+
+int BufferedFdWriter_t::write(const std::string &str)
+{
+    return append(str.data(), str.length());
+}
+
+int BufferedFdWriter_t::write(const char *str)
+{
+    return append(str, strlen(str));
+}
+
+int BufferedFdWriter_t::
+write(const std::string &str,
+      std::pair<std::string::const_iterator, std::string::const_iterator> interval)
+{
+    const char *cstr = str.data() + distance(str.begin(), interval.first);
+    return append(cstr, distance(interval.first, interval.second));
+}
+
+int BufferedFdWriter_t::writeStatic(const std::string &str)
+{
+    // short strings are cheaper to copy
+    if (str.length() < staticThreshold)
+        return append(str.data(), str.length());
+
+    if (fd < 0) return -1;
+
+    // reference string directly
+    closeChunk();
+    addVector(str.data(), str.length());
+
+    // do not hold too much data or too many vectors
+    if ((pending >= chunk.size()) || (vectors.size() >= MAX_VECTORS))
+        return flush();
+    return 0;
+}
+
+int BufferedFdWriter_t::append(const char *data, size_t length)
+{
+    if (fd < 0) return -1;
+    if (!length) return 0;
+
+    // flush when data does not fit into chunk buffer or when there
+    // is no room for next vector
+    if ((length > (chunk.size() - used)) || (vectors.size() >= MAX_VECTORS))
+        if (flush()) return -1;
+
+    // data larger than whole chunk buffer are written directly
+    if (length > chunk.size()) {
+        addVector(data, length);
+        return flush();
+    }
+
+    // copy data into chunk buffer
+    memcpy(&chunk[used], data, length);
+    used += length;
+    pending += length;
+    return 0;
+}
+
+void BufferedFdWriter_t::addVector(const char *data, size_t length)
+{
+    if (!length) return;
+    struct iovec v;
+    v.iov_base = const_cast<char*>(data);
+    v.iov_len = length;
+    vectors.push_back(v);
+    // chunk data are counted when copied
+    if ((data < &chunk[0]) || (data >= (&chunk[0] + chunk.size())))
+        pending += length;
+}
+
+void BufferedFdWriter_t::closeChunk()
+{
+    addVector(&chunk[unlisted], used - unlisted);
+    unlisted = used;
+}
+
+int BufferedFdWriter_t::flush() {
+    if (fd < 0) return -1;
+
+    // list rest of chunk buffer
+    closeChunk();
+
+    // write all vectors, handle partial writes
+    int ret = 0;
+    struct iovec *v = vectors.empty() ? 0 : &vectors[0];
+    size_t count = vectors.size();
+    while (count) {
+        ssize_t written = writev(fd, v, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            err.logSyscallError(Error_t::LL_FATAL, Error_t::Position_t(),
+                                "Error writing to output");
+            ret = -1;
+            break;
+        }
+        // nothing written => output cannot accept more data
+        if (!written) {
+            err.logError(Error_t::LL_FATAL, Error_t::Position_t(),
+                         "Output accepts no more data");
+            ret = -1;
+            break;
+        }
+        // skip completely written vectors
+        for (; count && (static_cast<size_t>(written) >= v->iov_len);
+             ++v, --count)
+            written -= v->iov_len;
+        // move start of partially written vector
+        if (count) {
+            v->iov_base = static_cast<char*>(v->iov_base) + written;
+            v->iov_len -= written;
+        }
+    }
+
+    // buffers are reused
+    vectors.clear();
+    used = unlisted = pending = 0;
+    return ret;
+}
+
 } // namespace Teng
 
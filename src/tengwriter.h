@@ -39,7 +39,10 @@
 #define TENGWRITER_H
 
 #include <string>
+#include <vector>
+#include <deque>
 #include <stdio.h>
+#include <sys/uio.h>
 
 #include <tengerror.h>
 
@@ -84,6 +87,23 @@ public:
                       std::pair<std::string::const_iterator,
                       std::string::const_iterator> interval) = 0;
 
+    /** @short Write given string to output.
+     *  Caller guarantees that the string is neither modified nor
+     *  destroyed until flush() so it can be referenced instead of
+     *  copied. Default implementation just calls write(str).
+     *  @param str string to be written
+     *  @return 0 OK, !0 error
+     */
+    virtual int writeStatic(const std::string &str) {
+        return write(str);
+    }
+
+    /** @short Hint that about size bytes are going to be written.
+     *  Default implementation does nothing.
+     *  @param size expected size of output
+     */
+    virtual void reserve(std::string::size_type) {}
+
     /** @short Flush buffered data to the output.
      *  Abstract, must be overloaded in subclass.
      *  @return 0 OK, !0 error
@@ -153,6 +173,11 @@ public:
      */
     virtual int flush() { return 0; }
 
+    /** @short Reserve room for expected output in associated string.
+     *  @param size expected size of output
+     */
+    virtual void reserve(std::string::size_type size);
+
 private:
     /**
      * @short Copy constructor intentionally private -- copying
@@ -171,6 +196,112 @@ private:
     std::string &str;
 };
 
+/** @short Output writer. Writes to the list of string segments.
+ *
+ *  Output is never reallocated nor copied into one contiguous
+ *  string; each segment has fixed capacity and new segment is started
+ *  when the last one is full. Segments can be sent to the client
+ *  directly (e.g. by writev(2)).
+ */
+class SegmentedWriter_t : public Writer_t {
+public:
+    /** @short Default capacity of one segment.
+     */
+    static const unsigned int DEFAULT_SEGMENT_SIZE = 65536;
+
+    /** @short List of segments.
+     */
+    typedef std::deque<std::string> Segments_t;
+
+    /** @short Creates new writer.
+     *  @param segmentSize capacity of one segment
+     */
+    SegmentedWriter_t(unsigned int segmentSize = DEFAULT_SEGMENT_SIZE);
+
+    /** @short Write given string to output.
+     *  @param str string to be written
+     *  @return 0 OK, !0 error
+     */
+    virtual int write(const std::string &str);
+
+    /** @short Write given string to output.
+     *  @param str string to be written
+     *  @return 0 OK, !0 error
+     */
+    virtual int write(const char *str);
+
+    /** @short Write given string to output.
+     *  @param str string to be written
+     *  @param interval iterators to given string, only this part
+     *                  shall be written
+     *  @return 0 OK, !0 error
+     */
+    virtual int write(const std::string &str,
+                      std::pair<std::string::const_iterator,
+                      std::string::const_iterator> interval);
+
+    /** @short Flush buffered data to the output.
+     *  No-op.
+     *  @return 0 OK, !0 error
+     */
+    virtual int flush() { return 0; }
+
+    /** @short Get written segments.
+     *  @return list of segments
+     */
+    inline const Segments_t& getSegments() const {
+        return segments;
+    }
+
+    /** @short Get size of whole output.
+     *  @return number of written bytes
+     */
+    inline std::string::size_type size() const {
+        return length;
+    }
+
+    /** @short Join segments into one string.
+     *  @return whole output
+     */
+    std::string str() const;
+
+    /** @short Drop written data.
+     */
+    void clear();
+
+private:
+    /**
+     * @short Copy constructor intentionally private -- copying
+     *        disabled.
+     */
+    SegmentedWriter_t(const SegmentedWriter_t&);
+
+    /**
+     * @short Assignment operator intentionally private -- assignment
+     *        disabled.
+     */
+    SegmentedWriter_t& operator=(const SegmentedWriter_t&);
+
+    /** @short Append data to the segments.
+     *  @param data data to be written
+     *  @param size length of data
+     *  @return 0 OK, !0 error
+     */
+    int append(const char *data, std::string::size_type size);
+
+    /** @short Written segments.
+     */
+    Segments_t segments;
+
+    /** @short Capacity of one segment.
+     */
+    unsigned int segmentSize;
+
+    /** @short Size of whole output.
+     */
+    std::string::size_type length;
+};
+
 /** @short 
  *  @param 
  *  @return 
@@ -243,6 +374,149 @@ private:
     bool borrowed;
 };
 
+/** @short Output writer. Writes to the file descriptor.
+ *
+ *  Data are collected in the chunk buffer of fixed size and written
+ *  by single writev(2) call when the buffer is full or on flush().
+ *  Long static strings (see writeStatic()) are not copied into the
+ *  buffer, only referenced from the list of pending output vectors.
+ */
+class BufferedFdWriter_t : public Writer_t {
+public:
+    /** @short Default size of chunk buffer.
+     */
+    static const unsigned int DEFAULT_CHUNK_SIZE = 16384;
+
+    /** @short Default minimal length of referenced static string.
+     */
+    static const unsigned int DEFAULT_STATIC_THRESHOLD = 256;
+
+    /** @short Create new writer.
+     *  @param filename file to open
+     *  @param chunkSize size of chunk buffer
+     *  @param staticThreshold static strings of this or greater
+     *                         length are referenced rather than copied
+     */
+    BufferedFdWriter_t(const std::string &filename,
+                       unsigned int chunkSize = DEFAULT_CHUNK_SIZE,
+                       unsigned int staticThreshold
+                       = DEFAULT_STATIC_THRESHOLD);
+
+    /** @short Create new writer from open file descriptor.
+     *  Descriptor is borrowed. It'll be not closed.
+     *  @param fd open file descriptor
+     *  @param chunkSize size of chunk buffer
+     *  @param staticThreshold static strings of this or greater
+     *                         length are referenced rather than copied
+     */
+    BufferedFdWriter_t(int fd,
+                       unsigned int chunkSize = DEFAULT_CHUNK_SIZE,
+                       unsigned int staticThreshold
+                       = DEFAULT_STATIC_THRESHOLD);
+
+    /** @short Destroy writer.
+     *  Pending data are flushed. Associated file descriptor will be
+     *  closed unles it's borrowed.
+     */
+    virtual ~BufferedFdWriter_t();
+
+    /** @short Write given string to output.
+     *  @param str string to be written
+     *  @return 0 OK, !0 error
+     */
+    virtual int write(const std::string &str);
+
+    /** @short Write given string to output.
+     *  @param str string to be written
+     *  @return 0 OK, !0 error
+     */
+    virtual int write(const char *str);
+
+    /** @short Write given string to output.
+     *  @param str string to be written
+     *  @param interval iterators to given string, only this part
+     *                  shall be written
+     *  @return 0 OK, !0 error
+     */
+    virtual int write(const std::string &str,
+                      std::pair<std::string::const_iterator,
+                      std::string::const_iterator> interval);
+
+    /** @short Write given string to output.
+     *  Long strings are referenced until flush().
+     *  @param str string to be written
+     *  @return 0 OK, !0 error
+     */
+    virtual int writeStatic(const std::string &str);
+
+    /** @short Flush buffered data to the output.
+     *  @return 0 OK, !0 error
+     */
+    virtual int flush();
+
+private:
+    /**
+     * @short Copy constructor intentionally private -- copying
+     *        disabled.
+     */
+    BufferedFdWriter_t(const BufferedFdWriter_t&);
+
+    /**
+     * @short Assignment operator intentionally private -- assignment
+     *        disabled.
+     */
+    BufferedFdWriter_t& operator=(const BufferedFdWriter_t&);
+
+    /** @short Copy data into chunk buffer.
+     *  @param data data to be written
+     *  @param length length of data
+     *  @return 0 OK, !0 error
+     */
+    int append(const char *data, size_t length);
+
+    /** @short Append output vector to the pending list.
+     *  @param data start of data
+     *  @param length length of data
+     */
+    void addVector(const char *data, size_t length);
+
+    /** @short Close vector of so far unlisted data from chunk buffer.
+     */
+    void closeChunk();
+
+    /** @short Output file descriptor.
+     */
+    int fd;
+
+    /** @short Indicates whether file descriptor is borrowed.
+     */
+    bool borrowed;
+
+    /** @short Static strings of this or greater length are referenced.
+     */
+    unsigned int staticThreshold;
+
+    /** @short Chunk buffer (never reallocated).
+     */
+    std::vector<char> chunk;
+
+    /** @short Number of used bytes in chunk buffer.
+     */
+    size_t used;
+
+    /** @short Start of chunk data not yet present in output vectors.
+     */
+    size_t unlisted;
+
+    /** @short Number of bytes waiting for output.
+     */
+    size_t pending;
+
+    /** @short Output vectors waiting for writev.
+     */
+    std::vector<struct iovec> vectors;
+};
+
 } // namespace Teng
 
 #endif // TENGWRITER_H
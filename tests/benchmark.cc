@@ -0,0 +1,68 @@
+#include <teng.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// Renders template many times and returns duration in seconds
+double measure(Teng::Teng_t &teng, const std::string &templ,
+               const Teng::Fragment_t &data, int iterations,
+               unsigned int &entries)
+{
+    struct timeval start, end;
+    gettimeofday(&start, 0);
+    for (int i = 0; i < iterations; ++i) {
+        std::string output;
+        Teng::StringWriter_t writer(output);
+        Teng::Error_t err;
+        teng.generatePage(templ, "", "", "", "text/html", "utf-8", data,
+                          writer, err);
+        entries = err.getEntries().size();
+    }
+    gettimeofday(&end, 0);
+    return (end.tv_sec - start.tv_sec)
+        + (end.tv_usec - start.tv_usec) / 1000000.0;
+}
+
+} // namespace
+
+int main(int argc, char * argv[]) {
+    int iterations = (argc > 1) ? atoi(argv[1]) : 1000;
+    int variables = (argc > 2) ? atoi(argv[2]) : 500;
+
+    // Template referencing many undefined variables (each one logs
+    // a warning)
+    std::ostringstream templ;
+    for (int i = 0; i < variables; ++i)
+        templ << "<p>${undefined" << i << "}</p>\n";
+
+    // Empty data tree
+    Teng::Fragment_t root;
+
+    // Collect everything
+    Teng::Teng_t::Settings_t all(1);
+    Teng::Teng_t tengAll("", all);
+
+    // Drop warnings before they are built
+    Teng::Teng_t::Settings_t errors(1);
+    errors.logLevel = Teng::Error_t::LL_ERROR;
+    Teng::Teng_t tengErrors("", errors);
+
+    unsigned int entriesAll = 0;
+    unsigned int entriesErrors = 0;
+    double timeAll = measure(tengAll, templ.str(), root, iterations,
+                             entriesAll);
+    double timeErrors = measure(tengErrors, templ.str(), root, iterations,
+                                entriesErrors);
+
+    printf("%d renders of %d undefined variables\n", iterations, variables);
+    printf("loglevel debug: %8.3f s (%u log entries)\n",
+           timeAll, entriesAll);
+    printf("loglevel error: %8.3f s (%u log entries)\n",
+           timeErrors, entriesErrors);
+    return 0;
+}
@@ -1,8 +1,21 @@
 #include <teng.h>
+#include <tengfilesystem.h>
+#include <tengdictionary.h>
+#include <tengconfiguration.h>
+#include <tengtemplate.h>
+#include <tengdatausage.h>
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
 
-//g++ -I/usr/src/gtest /usr/src/gtest/src/gtest-all.cc compare.cc -lteng
+//g++ -I/usr/src/gtest -I../src /usr/src/gtest/src/gtest-all.cc compare.cc -lteng
 
 namespace {
 std::string get_teng_output(const std::string& templ, const Teng::Fragment_t& data, 
@@ -18,6 +31,46 @@ std::string get_teng_output(const std::string& templ) {
     Teng::Fragment_t data;
     return get_teng_output(templ, data);
 }
+std::string get_teng_output(Teng::Teng_t& teng, const std::string& templ,
+        const Teng::Fragment_t& data, Teng::Error_t& err,
+        const std::string& param="", const std::string& dict="") {
+    std::string result;
+    Teng::StringWriter_t writer(result);
+    teng.generatePage(templ, dict, "", param, "text/html", "utf-8", data, writer, err);
+    return result;
+}
+// number of log entries of given level containing given text
+int count_errors(const Teng::Error_t& err, Teng::Error_t::Level_t level,
+        const std::string& text="") {
+    int result = 0;
+    const std::vector<Teng::Error_t::Entry_t>& entries = err.getEntries();
+    for (std::vector<Teng::Error_t::Entry_t>::const_iterator i = entries.begin();
+            i != entries.end(); ++i)
+        if ((i->level == level) && (i->message.find(text) != std::string::npos))
+            ++result;
+    return result;
+}
+// directory with dictionaries/configurations removed at the end of test
+struct TempDir_t {
+    TempDir_t() {
+        char name[] = "/tmp/tengtest-XXXXXX";
+        path = mkdtemp(name);
+    }
+    ~TempDir_t() {
+        for (std::vector<std::string>::const_iterator i = files.begin();
+                i != files.end(); ++i)
+            unlink((path + "/" + *i).c_str());
+        rmdir(path.c_str());
+    }
+    void write(const std::string& name, const std::string& contents) {
+        FILE* fp = fopen((path + "/" + name).c_str(), "wb");
+        fwrite(contents.data(), 1, contents.size(), fp);
+        fclose(fp);
+        files.push_back(name);
+    }
+    std::string path;
+    std::vector<std::string> files;
+};
 }
 
 TEST(Teng, EscapeDoubleDolar) {
@@ -83,6 +136,20 @@ TEST(Teng, AlwaysEscape) {
     EXPECT_EQ(get_teng_output("<?teng set $.__q = '\"kaktus&<>\"'?><?teng set $.__r = $.__q?><?teng set $.__s = $.__r?><?teng set $.__t = $.__s?>${.__t}"), "&amp;amp;amp;quot;kaktus&amp;amp;amp;amp;&amp;amp;amp;lt;&amp;amp;amp;gt;&amp;amp;amp;quot;");
 }
 
+TEST(Teng, EscapeLongValueTwoEscapers) {
+    Teng::Fragment_t data;
+    std::string clean(100, 'x');
+    data.addVariable(std::string("clean"), clean);
+    data.addVariable(std::string("dirty"), clean + "<\"a\">");
+
+    // the same values under html and quoted-string escaping
+    EXPECT_EQ(get_teng_output("${dirty}|${clean}|<?teng ctype \"quoted-string\"?>"
+                              "${dirty}|${clean}<?teng endctype?>|${dirty}", data),
+              clean + "&lt;&quot;a&quot;&gt;|" + clean + "|"
+              + clean + "<\\\"a\\\">|" + clean + "|"
+              + clean + "&lt;&quot;a&quot;&gt;");
+}
+
 TEST(Teng, BasicInt) {
     EXPECT_EQ(get_teng_output("${int(\"12\"++\"3.5\")}"), "123");
     EXPECT_EQ(get_teng_output("${int(22.567)}"), "22");
@@ -168,6 +235,987 @@ TEST(Teng, BasicUrlUnescape) {
     EXPECT_EQ(get_teng_output("${urlunescape(\"\%27asdf\%21\%40\%23\%24\%25\%5E\%26\%2A\%28\")}"), "'asdf!@#$%^&*\(");
 }
 
+TEST(Teng, FormatSpaceModes) {
+    Teng::Fragment_t data;
+    data.addVariable(std::string("name"), std::string("big  world"));
+    data.addVariable(std::string("x"), std::string("x"));
+    std::string body("  Hello,\n\t  ${name}  !  \n\n   second   line  \n"
+                     "  ${x}\n \n  last  <?teng endformat ?>");
+
+    // outputs of formatter before single-pass rewrite
+    EXPECT_EQ(get_teng_output("<?teng format space=\"noformat\" ?>" + body,
+                              data),
+              "  Hello,\n\t  big  world  !  \n\n   second   line  \n"
+              "  x\n \n  last  ");
+    EXPECT_EQ(get_teng_output("<?teng format space=\"nowhite\" ?>" + body,
+                              data),
+              "Hello,bigworld!secondlinexlast");
+    EXPECT_EQ(get_teng_output("<?teng format space=\"onespace\" ?>" + body,
+                              data),
+              " Hello, big world ! second line x last ");
+    EXPECT_EQ(get_teng_output("<?teng format space=\"striplines\" ?>" + body,
+                              data),
+              "  Hello,\nbig  world  !\nsecond   line\nx\nlast  ");
+    EXPECT_EQ(get_teng_output("<?teng format space=\"joinlines\" ?>" + body,
+                              data),
+              "  Hello,big  world  !  second   line  xlast  ");
+    EXPECT_EQ(get_teng_output("<?teng format space=\"nowhitelines\" ?>"
+                              + body, data),
+              "  Hello,\n\t  big  world  !  \n   second   line  \n"
+              "  x\n  last  ");
+}
+
+TEST(Teng, FormatPreformattedBoundaries) {
+    Teng::Fragment_t data;
+    data.addVariable(std::string("v"), std::string(" v  v "));
+
+    // outputs of runtime formatting (before static text was pre-formatted)
+    // static text between format blocks
+    EXPECT_EQ(get_teng_output("A  <?teng format space=\"onespace\" ?> x  y "
+                              "${v}  z  \n w <?teng endformat ?>  B  "
+                              "<?teng format space=\"nowhite\" ?>  p  q  "
+                              "<?teng endformat ?>  C", data),
+              "A   x y v v z w   B  pq  C");
+    // nested format blocks
+    EXPECT_EQ(get_teng_output("<?teng format space=\"onespace\" ?> a  b "
+                              "<?teng format space=\"nowhite\" ?> c  d ${v} "
+                              "e  f <?teng endformat ?> g  h "
+                              "<?teng endformat ?>", data),
+              " a b cdvvef g h ");
+    EXPECT_EQ(get_teng_output("<?teng format space=\"striplines\" ?>  a  \n"
+                              "  b  <?teng format space=\"joinlines\" ?>  c  \n"
+                              "  d  <?teng endformat ?>  e  \n"
+                              "  f  <?teng endformat ?>", data),
+              "  a\nb    c  d    e\nf  ");
+    // whitespaces joining dynamic values
+    EXPECT_EQ(get_teng_output("<?teng format space=\"onespace\" ?>  a  ${v}${v}"
+                              "  b  <?teng format space=\"noformat\" ?>  c  "
+                              "${v}  d  <?teng endformat ?>  e  "
+                              "<?teng endformat ?>", data),
+              " a v v v v b   c   v  v   d   e ");
+
+    // static text is really pre-formatted
+    TempDir_t dir;
+    dir.write("teng.conf", "%enable bytecode\n");
+    Teng::Teng_t teng(dir.path, Teng::Teng_t::Settings_t());
+    Teng::Error_t err;
+    std::string output = get_teng_output(teng, "<?teng format space="
+                                         "\"onespace\" ?> x  y <?teng "
+                                         "endformat ?><?teng bytecode ?>",
+                                         data, err, "teng.conf");
+    EXPECT_EQ(output.substr(0, 5), " x y ");
+    EXPECT_NE(output.find("&lt;preformatted&gt;"), std::string::npos);
+}
+
+namespace {
+// remembers output written between flushes
+struct FlushRecordingWriter_t : public Teng::Writer_t {
+    int write(const std::string& str) {
+        current.append(str);
+        return 0;
+    }
+    int write(const char* str) {
+        current.append(str);
+        return 0;
+    }
+    int write(const std::string&,
+              std::pair<std::string::const_iterator,
+              std::string::const_iterator> interval) {
+        current.append(interval.first, interval.second);
+        return 0;
+    }
+    int flush() {
+        chunks += current + "|";
+        current.clear();
+        return 0;
+    }
+    std::string current;
+    std::string chunks;
+};
+// output chunks of template rendered with given configuration
+std::string flushed_chunks(const TempDir_t& dir, const std::string& conf,
+        const std::string& templ) {
+    Teng::Fragment_t data;
+    data.addVariable("v", "12");
+    for (int i = 0; i < 2; ++i) {
+        Teng::Fragment_t& a = data.addFragment("a");
+        a.addFragment("b");
+        a.addFragment("b");
+    }
+    Teng::Teng_t teng(dir.path, Teng::Teng_t::Settings_t());
+    FlushRecordingWriter_t writer;
+    Teng::Error_t err;
+    teng.generatePage(templ, "", "", conf, "text/html", "utf-8", data,
+                      writer, err);
+    return writer.chunks + writer.current;
+}
+}
+
+TEST(Teng, FlushWriter) {
+    TempDir_t dir;
+    dir.write("none.conf", "");
+    dir.write("threshold.conf", "%flushthreshold 4\n");
+    dir.write("frag.conf", "%enable flushonfrag\n");
+    std::string frags("head<?teng frag a ?>[<?teng frag b ?>x"
+                      "<?teng endfrag ?>]<?teng endfrag ?>tail"
+                      "<?teng frag a ?>a<?teng endfrag ?>");
+
+    // end of page flushes twice (processor and generatePage)
+    EXPECT_EQ(flushed_chunks(dir, "none.conf", "a<?teng flush ?>b${v}"
+                             "<?teng flush ?>c"), "a|b12|c||");
+    EXPECT_EQ(flushed_chunks(dir, "none.conf", frags),
+              "head[xx][xx]tailaa||");
+    EXPECT_EQ(flushed_chunks(dir, "threshold.conf", "ab${v}cd${v}efghij${v}k"),
+              "ab12|cd12|efghij|12k||");
+    // only entering outermost fragment flushes (not its iterations or
+    // nested fragments)
+    EXPECT_EQ(flushed_chunks(dir, "frag.conf", frags),
+              "head|[xx][xx]tail|aa||");
+}
+
+namespace {
+// writev() on this descriptor writes at most writevLimit bytes per call
+int limitedFd = -1;
+size_t writevLimit = 0;
+// starts of all vectors passed to limited writev()
+std::vector<const void*> writevBases;
+}
+
+// replaces writev(2) of libc to simulate partial writes
+extern "C" ssize_t writev(int fd, const struct iovec* iov, int iovcnt) {
+    if (fd != limitedFd) return syscall(SYS_writev, fd, iov, iovcnt);
+    std::vector<struct iovec> limited;
+    size_t rest = writevLimit;
+    for (int i = 0; i < iovcnt; ++i) {
+        writevBases.push_back(iov[i].iov_base);
+        if (!rest) continue;
+        limited.push_back(iov[i]);
+        if (limited.back().iov_len > rest) limited.back().iov_len = rest;
+        rest -= limited.back().iov_len;
+    }
+    if (limited.empty()) return 0;
+    return syscall(SYS_writev, fd, &limited[0], limited.size());
+}
+
+TEST(Teng, BufferedFdWriterPartialWrites) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    limitedFd = fds[1];
+    writevLimit = 7;
+    writevBases.clear();
+
+    // chunk of 64 bytes, static strings of 16 or more bytes referenced
+    std::string expected;
+    std::string shortStatic(10, 's');
+    std::string longStatic(40, 'L');
+    std::string huge(100, 'H');
+    {
+        Teng::BufferedFdWriter_t writer(fds[1], 64, 16);
+        for (int i = 0; i < 100; ++i) {
+            char number[16];
+            sprintf(number, "<%d>", i);
+            EXPECT_EQ(writer.write(number), 0);
+            EXPECT_EQ(writer.writeStatic(shortStatic), 0);
+            EXPECT_EQ(writer.writeStatic(longStatic), 0);
+            expected += number + shortStatic + longStatic;
+            if (i % 10 == 0) {
+                EXPECT_EQ(writer.write(huge), 0);
+                expected += huge;
+            }
+        }
+        EXPECT_EQ(writer.flush(), 0);
+        EXPECT_TRUE(writer.getErrors().getEntries().empty());
+    }
+    // long static string is referenced, short one is copied
+    EXPECT_NE(std::find(writevBases.begin(), writevBases.end(),
+                        longStatic.data()), writevBases.end());
+    EXPECT_EQ(std::find(writevBases.begin(), writevBases.end(),
+                        shortStatic.data()), writevBases.end());
+
+    std::string output(expected.size(), '\0');
+    size_t got = 0;
+    while (got < output.size()) {
+        ssize_t r = read(fds[0], &output[got], output.size() - got);
+        if (r <= 0) break;
+        got += r;
+    }
+    EXPECT_EQ(output, expected);
+
+    // output accepting nothing is an error (not an endless loop)
+    writevLimit = 0;
+    {
+        Teng::BufferedFdWriter_t writer(fds[1], 64, 16);
+        EXPECT_EQ(writer.write("lost"), 0);
+        EXPECT_NE(writer.flush(), 0);
+        EXPECT_EQ(writer.getErrors().getEntries().size(), 1u);
+    }
+    limitedFd = -1;
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(Teng, SegmentedWriterBoundaries) {
+    Teng::SegmentedWriter_t writer(8);
+    EXPECT_EQ(writer.write("abc"), 0);
+    EXPECT_EQ(writer.write("defgh"), 0);      // fills first segment
+    EXPECT_EQ(writer.write(""), 0);
+    EXPECT_EQ(writer.write(std::string("0123456789ABCDEFGHIJ")), 0);
+    std::string text("--xyz--");
+    EXPECT_EQ(writer.write(text, std::make_pair(text.begin() + 2,
+                                                text.end() - 2)), 0);
+
+    const Teng::SegmentedWriter_t::Segments_t& segments
+        = writer.getSegments();
+    ASSERT_EQ(segments.size(), 4u);
+    EXPECT_EQ(segments[0], "abcdefgh");
+    EXPECT_EQ(segments[1], "01234567");
+    EXPECT_EQ(segments[2], "89ABCDEF");
+    EXPECT_EQ(segments[3], "GHIJxyz");
+    EXPECT_EQ(writer.size(), 31u);
+    EXPECT_EQ(writer.str(), "abcdefgh0123456789ABCDEFGHIJxyz");
+
+    // page output
+    writer.clear();
+    EXPECT_EQ(writer.size(), 0u);
+    Teng::Fragment_t data;
+    data.addVariable("v", "0123456789");
+    Teng::Teng_t teng("", Teng::Teng_t::Settings_t());
+    Teng::Error_t err;
+    teng.generatePage("<${v}|${v}>", "", "", "", "text/html", "utf-8", data,
+                      writer, err);
+    EXPECT_EQ(writer.getSegments().size(), 3u);
+    EXPECT_EQ(writer.str(), "<0123456789|0123456789>");
+}
+
+namespace {
+// remembers sizes passed to reserve()
+struct ReserveRecordingWriter_t : public Teng::StringWriter_t {
+    ReserveRecordingWriter_t() : Teng::StringWriter_t(output) {}
+    void reserve(std::string::size_type size) {
+        reserved.push_back(size);
+    }
+    std::string output;
+    std::vector<std::string::size_type> reserved;
+};
+}
+
+TEST(Teng, OutputSizeEstimate) {
+    Teng::Teng_t teng("", Teng::Teng_t::Settings_t());
+    std::string templ("static text ${v}");
+    ReserveRecordingWriter_t writer;
+    Teng::Error_t err;
+    Teng::Fragment_t data;
+    data.addVariable("v", std::string(88, 'v'));
+    for (int i = 0; i < 2; ++i)
+        teng.generatePage(templ, "", "", "", "text/html", "utf-8", data,
+                          writer, err);
+    data.addVariable("v", std::string(388, 'v'));
+    for (int i = 0; i < 2; ++i)
+        teng.generatePage(templ, "", "", "", "text/html", "utf-8", data,
+                          writer, err);
+
+    ASSERT_EQ(writer.reserved.size(), 4u);
+    // static size for the first time, then cached estimate
+    EXPECT_EQ(writer.reserved[0], 12u);
+    EXPECT_EQ(writer.reserved[1], 100u);
+    EXPECT_EQ(writer.reserved[2], 100u);
+    // moving average follows size of output
+    EXPECT_EQ(writer.reserved[3], 100u - 25u + 100u);
+}
+
+namespace {
+// a[3] with 1, 2 and 3 nested b fragments, c[2]
+void add_nested_siblings(Teng::Fragment_t& data) {
+    for (int i = 0; i < 3; ++i) {
+        Teng::Fragment_t& a = data.addFragment("a");
+        for (int j = 0; j <= i; ++j) a.addFragment("b");
+    }
+    data.addFragment("c");
+    data.addFragment("c");
+}
+}
+
+TEST(Teng, FragmentIterationState) {
+    Teng::Fragment_t data;
+    add_nested_siblings(data);
+
+    // nested and sibling fragments
+    EXPECT_EQ(get_teng_output("<?teng frag a ?>(${_number}/${_count} "
+                              "${_first}${_last}${_inner}:<?teng frag b ?>"
+                              "[${_number}/${_count}${_first}${_last}${_inner}"
+                              " ${a._number}${a._first}${a._last}${a._inner}]"
+                              "<?teng endfrag ?>)<?teng endfrag ?>"
+                              "<?teng frag c ?>{${_number}${_count}${_first}"
+                              "${_last}${_inner}}<?teng endfrag ?>", data),
+              "(0/3 100:[0/1110 0100])"
+              "(1/3 001:[0/2100 1001][1/2010 1001])"
+              "(2/3 010:[0/3100 2010][1/3001 2010][2/3010 2010])"
+              "{02100}{12010}");
+
+    // sizes of fragments that are not open
+    EXPECT_EQ(get_teng_output("<?teng frag a ?>${.a.b._count}<?teng frag b ?>"
+                              "${.a._number}${.a._last}<?teng endfrag ?>;"
+                              "<?teng endfrag ?>|${.a._count}${.c._count}"
+                              "<?teng frag c ?>${.a._count}<?teng endfrag ?>",
+                              data),
+              "100;21010;3212121;|3233");
+    // repeated in nested loop
+    EXPECT_EQ(get_teng_output("<?teng frag a ?><?teng frag b ?>${.a.b._count}"
+                              "${.c._count}<?teng endfrag ?>,<?teng endfrag ?>",
+                              data),
+              "12,2222,323232,");
+}
+
+TEST(Teng, FragmentLocalVariables) {
+    Teng::Fragment_t data;
+    add_nested_siblings(data);
+
+    // locals live in one iteration only and are not seen by nested
+    // fragments
+    EXPECT_EQ(get_teng_output("<?teng frag a ?>${exist(x)}<?teng if $_first ?>"
+                              "<?teng set x = \"F\" ?><?teng endif ?>${x}"
+                              "<?teng set x = $_number ?>${x}"
+                              "<?teng frag b ?><?teng set y = $x ++ $_number ?>"
+                              "${y}<?teng endfrag ?>${exist(y)};"
+                              "<?teng endfrag ?>", data),
+              "0F000;01010;020120;");
+    EXPECT_EQ(get_teng_output("<?teng frag a ?><?teng frag b ?>${exist(z)}"
+                              "<?teng set z = \"z\" ?><?teng endfrag ?>"
+                              "<?teng endfrag ?>", data),
+              "000000");
+
+    // local of fragment versus variable of root
+    EXPECT_EQ(get_teng_output("<?teng set g = \"G\" ?><?teng frag a ?>${g}"
+                              "<?teng set g = \"L\" ?>${g}<?teng set .g = \"R\" ?>"
+                              "<?teng endfrag ?>${g}", data),
+              "LLLR");
+}
+
+namespace {
+// renders nested page by the same engine when fragment is read
+struct RenderingGenerator_t : public Teng::FragmentGenerator_t {
+    RenderingGenerator_t(Teng::Teng_t& teng, const std::string& templ)
+        : teng(teng), templ(templ) {}
+    int generate(Teng::Fragment_t& fragment) {
+        Teng::Fragment_t data;
+        add_nested_siblings(data);
+        Teng::Error_t err;
+        fragment.addVariable("page", get_teng_output(teng, templ, data, err));
+        return 0;
+    }
+    Teng::Teng_t& teng;
+    std::string templ;
+};
+}
+
+TEST(Teng, FragmentStorageReuse) {
+    std::string templ("<?teng frag a ?>${exist(x)}<?teng set x = $_number ?>"
+                      "${x}<?teng frag b ?>${_number}<?teng set y = 1 ?>"
+                      "<?teng endfrag ?>;<?teng endfrag ?>");
+    std::string other("<?teng frag c ?>${exist(y)}${exist(x)}"
+                      "<?teng set y = 2 ?><?teng endfrag ?>");
+    Teng::Fragment_t large;
+    add_nested_siblings(large);
+    Teng::Fragment_t small;
+    small.addFragment("a").addFragment("b");
+    small.addFragment("c");
+
+    // the same engine (and its frame storage) renders all pages
+    Teng::Teng_t teng("", Teng::Teng_t::Settings_t());
+    Teng::Error_t err;
+    EXPECT_EQ(get_teng_output(teng, templ, large, err), "000;0101;02012;");
+    EXPECT_EQ(get_teng_output(teng, templ, small, err), "000;");
+    EXPECT_EQ(get_teng_output(teng, other, small, err), "00");
+    EXPECT_EQ(get_teng_output(teng, templ, large, err), "000;0101;02012;");
+
+    // page rendered (once) while another one is being rendered
+    RenderingGenerator_t generator(teng, templ);
+    Teng::Fragment_t outer;
+    add_nested_siblings(outer);
+    outer.addFragment("lazy").setGenerator(&generator);
+    EXPECT_EQ(get_teng_output(teng, "<?teng frag a ?>${_number}<?teng set x = 1 ?>"
+                              "<?teng frag .lazy ?>[${page}]<?teng endfrag ?>"
+                              "${x}<?teng endfrag ?>", outer, err),
+              "0[000;0101;02012;]11[000;0101;02012;]1"
+              "2[000;0101;02012;]1");
+}
+
+TEST(Teng, DataUsagePaths) {
+    typedef Teng::DataUsage_t Usage_t;
+    Teng::Teng_t teng("", Teng::Teng_t::Settings_t());
+    Usage_t usage;
+    Teng::Error_t err;
+    EXPECT_EQ(teng.getDataUsage("${title}<?teng frag row ?>${name}"
+                                "<?teng frag cell ?>${value}${_number}"
+                                "<?teng endfrag ?>${exist(flag)}"
+                                "${.other._count}<?teng endfrag ?>"
+                                "${exist(.opt.x)}${$$row.name}"
+                                "${$$.meta.info}${exist($$.meta.more)}"
+                                "${$$.list[0].name}${jsonify($$data)}",
+                                "", "", "", usage, err), 0);
+    EXPECT_FALSE(usage.isEverythingUsed());
+
+    Usage_t::Paths_t expected;
+    expected[".title"] = Usage_t::US_VARIABLE;
+    expected[".row"] = Usage_t::US_FRAGMENT;
+    expected[".row.name"] = Usage_t::US_VARIABLE;
+    expected[".row.cell"] = Usage_t::US_FRAGMENT;
+    expected[".row.cell.value"] = Usage_t::US_VARIABLE;
+    expected[".row.flag"] = Usage_t::US_EXIST;
+    expected[".other"] = Usage_t::US_FRAGMENT;
+    // .opt.x is not in template => exist() is false at compile time
+    expected[".meta.info"] = Usage_t::US_VARIABLE;
+    expected[".meta.more"] = Usage_t::US_EXIST;
+    expected[".list"] = Usage_t::US_VARIABLE | Usage_t::US_SUBTREE;
+    expected[".data"] = Usage_t::US_VARIABLE | Usage_t::US_SUBTREE;
+    EXPECT_EQ(usage.getPaths(), expected);
+
+    EXPECT_TRUE(usage.isUsed(".row"));
+    EXPECT_TRUE(usage.isUsed(".list.item.name"));
+    EXPECT_FALSE(usage.isUsed(".opt"));
+    EXPECT_FALSE(usage.isUsed(".row.unused"));
+
+    // file template with include, debug dump reads everything
+    TempDir_t dir;
+    dir.write("main.html", "${title}<?teng include file=\"part.html\" ?>");
+    dir.write("part.html", "<?teng frag row ?>${name}<?teng endfrag ?>");
+    dir.write("teng.conf", "%enable debug\n");
+    dir.write("debug.html", "<?teng debug ?>");
+    Teng::Teng_t fileTeng(dir.path, Teng::Teng_t::Settings_t());
+    EXPECT_EQ(fileTeng.getDataUsage("main.html", "", "", "", "", usage, err),
+              0);
+    Usage_t::Paths_t included;
+    included[".title"] = Usage_t::US_VARIABLE;
+    included[".row"] = Usage_t::US_FRAGMENT;
+    included[".row.name"] = Usage_t::US_VARIABLE;
+    EXPECT_EQ(usage.getPaths(), included);
+    EXPECT_EQ(fileTeng.getDataUsage("debug.html", "", "", "", "teng.conf",
+                                    usage, err), 0);
+    EXPECT_TRUE(usage.isEverythingUsed());
+}
+
+TEST(Teng, SwapVariableBuffers) {
+    Teng::Fragment_t data;
+    std::string first(100, 'a');
+    const char* firstBuffer = first.data();
+    std::string second(100, 'b');
+    const char* secondBuffer = second.data();
+
+    // new variable => caller gets empty string
+    data.swapVariable("v", first);
+    EXPECT_TRUE(first.empty());
+    EXPECT_EQ(get_teng_output("${v}", data), std::string(100, 'a'));
+
+    // existing variable => caller gets previous content and buffer
+    data.swapVariable("v", second);
+    EXPECT_EQ(first.size(), 0u);
+    EXPECT_EQ(second, std::string(100, 'a'));
+    EXPECT_EQ(second.data(), firstBuffer);
+    EXPECT_EQ(get_teng_output("${v}", data), std::string(100, 'b'));
+
+    // reused name starts empty but keeps buffer
+    std::string& emplaced = data.emplaceVariable("v");
+    EXPECT_TRUE(emplaced.empty());
+    EXPECT_EQ(emplaced.data(), secondBuffer);
+    emplaced = "c";
+    EXPECT_EQ(get_teng_output("${v}", data), "c");
+
+    // name unused since reset gives empty string
+    data.reset();
+    std::string third("d");
+    data.swapVariable("v", third);
+    EXPECT_TRUE(third.empty());
+    EXPECT_EQ(third.data(), secondBuffer);
+    EXPECT_EQ(get_teng_output("${v}", data), "d");
+    data.reset();
+    EXPECT_TRUE(data.emplaceVariable("v").empty());
+
+    // string column of columnar list
+    Teng::FragmentList_t& rows = data.addFragmentList("row");
+    int column = rows.addColumn("name");
+    unsigned int row = rows.addRow();
+    std::string cell(100, 'x');
+    const char* cellBuffer = cell.data();
+    rows.swapValue(row, column, cell);
+    EXPECT_TRUE(cell.empty());
+    std::string other("y");
+    rows.swapValue(row, column, other);
+    EXPECT_EQ(other, std::string(100, 'x'));
+    EXPECT_EQ(other.data(), cellBuffer);
+
+    // reused row starts empty
+    data.reset();
+    Teng::FragmentList_t& reused = data.addFragmentList("row");
+    row = reused.addRow();
+    std::string buffer;
+    EXPECT_EQ(reused.getValue(row, column, buffer), "");
+    EXPECT_EQ(get_teng_output("<?teng frag row ?>[${name}]<?teng endfrag ?>",
+                              data), "[]");
+}
+
+TEST(Teng, ColumnarListShape) {
+    Teng::Fragment_t data;
+    Teng::FragmentList_t &columnar = data.addFragmentList("columnar");
+    EXPECT_THROW(columnar.addRow(), std::logic_error);
+    EXPECT_FALSE(columnar.isColumnar());
+    EXPECT_EQ(columnar.addColumn("name"), 0);
+    EXPECT_EQ(columnar.addRow(), 0u);
+    EXPECT_THROW(columnar.addFragment(), std::logic_error);
+
+    Teng::FragmentList_t &fragments = data.addFragmentList("fragments");
+    fragments.addFragment();
+    EXPECT_EQ(fragments.addColumn("name"), -1);
+    EXPECT_FALSE(fragments.isColumnar());
+}
+
+TEST(Teng, ResetRefillDifferentShape) {
+    std::string templ = "${exist(a)}${exist(b)}${c}"
+        "<?teng frag item ?>[${_count}:${exist(x)}${y}]<?teng endfrag ?>"
+        "<?teng frag row ?>(${_count}:${name})<?teng endfrag ?>";
+
+    Teng::Fragment_t data;
+    data.addVariable("a", "A");
+    data.addVariable("b", "B");
+    Teng::FragmentList_t &items = data.addFragmentList("item");
+    for (int i = 0; i < 3; ++i) items.addFragment().addVariable("x", "X");
+    Teng::FragmentList_t &rows = data.addFragmentList("row");
+    rows.addColumn("name");
+    rows.addRow();
+    rows.addRow();
+    EXPECT_EQ(get_teng_output(templ, data),
+              "11[3:1][3:1][3:1](2:)(2:)");
+
+    // different shape: variables and rows of previous fill must vanish
+    data.reset();
+    data.addVariable("c", "C");
+    data.addFragmentList("item").addFragment().addVariable("y", "Y");
+    Teng::FragmentList_t &rows2 = data.addFragmentList("row");
+    EXPECT_TRUE(rows2.isColumnar());
+    rows2.addRow();
+    EXPECT_EQ(get_teng_output(templ, data), "00C[1:0Y](1:)");
+
+    // names unused since previous reset are dropped, shape is kept
+    data.reset();
+    data.reset();
+    data.addVariable("a", "A");
+    EXPECT_EQ(get_teng_output(templ, data), "10");
+
+    // clear drops columns too
+    data.clear();
+    Teng::FragmentList_t &rows3 = data.addFragmentList("row");
+    EXPECT_FALSE(rows3.isColumnar());
+    rows3.addFragment().addVariable("name", "N");
+    EXPECT_EQ(get_teng_output(templ, data), "00(1:N)");
+}
+
+namespace {
+// counts its runs, fills fragment with variable x and fragment sub
+struct CountingGenerator_t : public Teng::FragmentGenerator_t {
+    CountingGenerator_t() : runs(0) {}
+    int generate(Teng::Fragment_t& fragment) {
+        ++runs;
+        fragment.addVariable("x", "X");
+        fragment.addFragment("sub").addVariable("y", "Y");
+        return 0;
+    }
+    int runs;
+};
+// number of generator runs while rendering given template
+int generator_runs(const std::string& templ, std::string& output,
+        const std::string& param="", const std::string& root="") {
+    Teng::Fragment_t data;
+    data.addVariable("z", "Z");
+    CountingGenerator_t generator;
+    data.addFragment("lazy").setGenerator(&generator);
+    Teng::Teng_t teng(root, Teng::Teng_t::Settings_t());
+    Teng::Error_t err;
+    output = get_teng_output(teng, templ, data, err, param);
+    return generator.runs;
+}
+}
+
+TEST(Teng, LazyFragmentGenerator) {
+    std::string output;
+    // never touched
+    EXPECT_EQ(generator_runs("${z}<?teng frag other ?>${x}<?teng endfrag ?>",
+                             output), 0);
+    EXPECT_EQ(output, "Z");
+    EXPECT_EQ(generator_runs("${exist(lazy)}", output), 0);
+    EXPECT_EQ(output, "1");
+
+    // variable lookup
+    EXPECT_EQ(generator_runs("<?teng frag lazy ?>${x}${x}"
+                             "<?teng frag sub ?>${y}<?teng endfrag ?>"
+                             "<?teng endfrag ?>", output), 1);
+    EXPECT_EQ(output, "XXY");
+
+    // GETATTR
+    EXPECT_EQ(generator_runs("${$$lazy.x}${$$.lazy.sub.y}${$$lazy.x}",
+                             output), 1);
+    EXPECT_EQ(output, "XYX");
+    EXPECT_EQ(generator_runs("<?teng frag lazy ?>${$$x}<?teng endfrag ?>",
+                             output), 1);
+    EXPECT_EQ(output, "X");
+
+    // dump of the fragment itself and debug dump of the whole tree
+    EXPECT_EQ(generator_runs("${jsonify($$lazy)}", output), 1);
+    EXPECT_EQ(output, "[{\"sub\" : [{\"y\" : \"Y\"}], \"x\" : \"X\"}]");
+    TempDir_t dir;
+    dir.write("teng.conf", "%enable debug\n");
+    EXPECT_EQ(generator_runs("<?teng debug ?>", output, "teng.conf",
+                             dir.path), 1);
+    EXPECT_NE(output.find("y: &quot;Y&quot;"), std::string::npos);
+}
+
+TEST(Teng, NativeNumbers) {
+    Teng::Fragment_t data;
+    data.addVariable("i", Teng::IntType_t(7));
+    data.addVariable("r", 2.5);
+    data.addVariable("tiny", 1e-7);
+    data.addVariable("s", "3");
+    Teng::FragmentList_t &rows = data.addFragmentList("row");
+    int ci = rows.addColumn("ci", Teng::FragmentList_t::COLUMN_INT);
+    int cr = rows.addColumn("cr", Teng::FragmentList_t::COLUMN_REAL);
+    unsigned int row = rows.addRow();
+    rows.setValue(row, ci, Teng::IntType_t(5));
+    rows.setValue(row, cr, 0.25);
+
+    // arithmetic keeps integer and real types
+    EXPECT_EQ(get_teng_output("${i}|${$i + 1}|${$i / 2}|${$i + $r}|${$r * 2}"
+                              "|${$s + 1}", data),
+              "7|8|3|9.5|5.0|4");
+    EXPECT_EQ(get_teng_output("<?teng frag row ?>${ci}|${cr}|${$ci * 2}"
+                              "|${$ci / 2}|${$cr + 1}<?teng endfrag ?>", data),
+              "5|0.25|10|2|1.25");
+    EXPECT_EQ(get_teng_output("${$$.row.ci + 1}|${$$.row.cr * 4}", data),
+              "6|1.0");
+
+    // printed formatted, computed with native value
+    EXPECT_EQ(get_teng_output("${tiny}|${$tiny * 10000000}|${$tiny == 0}",
+                              data),
+              "0.0|1.0|0");
+
+    EXPECT_EQ(get_teng_output("${numformat($r, 2)}|${numformat($i, 1)}"
+                              "|${numformat($tiny, 8)}", data),
+              "2.50|7.0|0.00000010");
+    EXPECT_EQ(get_teng_output("<?teng frag row ?>${numformat($cr, 3)}"
+                              "|${numformat($ci, 2)}<?teng endfrag ?>", data),
+              "0.250|5.00");
+}
+
+TEST(Teng, DictIndirectFolding) {
+    TempDir_t dir;
+    dir.write("dict.txt", "greeting Hello\nkey_a A\n");
+    dir.write("teng.conf", "%enable bytecode\n");
+    Teng::Teng_t teng(dir.path, Teng::Teng_t::Settings_t());
+    Teng::Fragment_t data;
+    data.addVariable("name", "a");
+
+    // constant key found => folded into VAL
+    Teng::Error_t found;
+    std::string output = get_teng_output(teng, "${@\"greeting\"}|"
+                                         "<?teng bytecode ?>", data, found,
+                                         "teng.conf", "dict.txt");
+    EXPECT_EQ(output.substr(0, 6), "Hello|");
+    EXPECT_EQ(output.find("DICT"), std::string::npos);
+    EXPECT_TRUE(found.getEntries().empty());
+
+    // missing key => left for runtime which warns
+    Teng::Error_t missing;
+    output = get_teng_output(teng, "${@\"missing\"}|<?teng bytecode ?>",
+                             data, missing, "teng.conf", "dict.txt");
+    EXPECT_EQ(output.substr(0, 8), "missing|");
+    EXPECT_NE(output.find("DICT"), std::string::npos);
+    EXPECT_EQ(count_errors(missing, Teng::Error_t::LL_WARNING,
+                           "Dictionary item 'missing' was not found"), 1);
+
+    // non-constant key => not folded
+    Teng::Error_t variable;
+    output = get_teng_output(teng, "${@(\"key_\" ++ $name)}|"
+                             "<?teng bytecode ?>", data, variable,
+                             "teng.conf", "dict.txt");
+    EXPECT_EQ(output.substr(0, 2), "A|");
+    EXPECT_NE(output.find("DICT"), std::string::npos);
+    EXPECT_TRUE(variable.getEntries().empty());
+}
+
+TEST(Teng, ErrorLogManyEntries) {
+    // more entries than initial size of index
+    Teng::Error_t shared;
+    for (int i = 0; i < 40; ++i)
+        shared.logError(Teng::Error_t::LL_ERROR,
+                        Teng::Error_t::Position_t("shared", i + 1, 0),
+                        "shared error");
+
+    Teng::Error_t local;
+    for (int i = 0; i < 40; ++i)
+        local.logError(Teng::Error_t::LL_WARNING,
+                       Teng::Error_t::Position_t("local", i + 1, 0),
+                       "local error");
+    local.appendShared(shared);
+    EXPECT_EQ(local.count(), 80);
+    ASSERT_EQ(local.getEntries().size(), 80u);
+
+    // repeated entries are still found after materialization
+    local.logError(Teng::Error_t::LL_ERROR,
+                   Teng::Error_t::Position_t("shared", 40, 0),
+                   "shared error");
+    local.logError(Teng::Error_t::LL_WARNING,
+                   Teng::Error_t::Position_t("local", 1, 0),
+                   "local error");
+    ASSERT_EQ(local.getEntries().size(), 80u);
+    EXPECT_EQ(local.getEntries()[0].count, 2u);
+    EXPECT_EQ(local.getEntries()[79].count, 2u);
+
+    Teng::Error_t copied;
+    copied.append(local);
+    copied.append(shared);
+    ASSERT_EQ(copied.getEntries().size(), 80u);
+    EXPECT_EQ(copied.getEntries()[79].count, 3u);
+}
+
+TEST(Teng, DictionaryImageRoundTrip) {
+    Teng::InMemoryFilesystem_t filesystem;
+    filesystem.storage["text.dict"] =
+        "title Hello world\n"
+        "long first part\n"
+        "   second part\n"
+        "\n"
+        "_under score\n"
+        ".dotted value\n";
+    for (int i = 0; i < 40; ++i) {
+        std::ostringstream line;
+        line << "key" << i << " value " << i << "\n";
+        filesystem.storage["text.dict"] += line.str();
+    }
+
+    Teng::Dictionary_t text("");
+    EXPECT_EQ(text.parse(&filesystem, "text.dict"), 0);
+
+    std::string image;
+    EXPECT_EQ(text.compile(image), 0);
+    filesystem.storage["image.dict"] = image;
+
+    Teng::Dictionary_t binary("");
+    EXPECT_EQ(binary.parse(&filesystem, "image.dict"), 0);
+
+    const char *keys[] = { "title", "long", "_under", ".dotted", "key0",
+                           "key17", "key39", "missing", "key40" };
+    for (unsigned int i = 0; i < sizeof(keys) / sizeof(*keys); ++i) {
+        const std::string *expected = text.lookup(keys[i]);
+        const std::string *got = binary.lookup(keys[i]);
+        ASSERT_EQ(expected == 0, got == 0) << keys[i];
+        if (expected) EXPECT_EQ(*expected, *got) << keys[i];
+    }
+    EXPECT_EQ(*binary.lookup("long"), "first part second part");
+}
+
+namespace {
+// tree: item[name, item[name, item[...]]] of given depth
+void add_chain(Teng::Fragment_t& parent, int depth, int level=0) {
+    if (level == depth) return;
+    Teng::Fragment_t& item = parent.addFragment("item");
+    std::ostringstream name;
+    name << "n" << level;
+    item.addVariable(std::string("name"), name.str());
+    add_chain(item, depth, level + 1);
+}
+}
+
+TEST(Teng, RepeatFragTree) {
+    Teng::Fragment_t data;
+    Teng::Fragment_t& a = data.addFragment("item");
+    a.addVariable(std::string("name"), std::string("a"));
+    Teng::Fragment_t& b = a.addFragment("item");
+    b.addVariable(std::string("name"), std::string("b"));
+    Teng::Fragment_t& c = b.addFragment("item");
+    c.addVariable(std::string("name"), std::string("c"));
+    Teng::Fragment_t& d = a.addFragment("item");
+    d.addVariable(std::string("name"), std::string("d"));
+
+    EXPECT_EQ(get_teng_output("<?teng frag item?>(${name}:${_number}"
+                              "<?teng repeatfrag .item?>)<?teng endfrag?>",
+                              data),
+              "(a:0(b:0(c:0))(d:1))");
+}
+
+TEST(Teng, RepeatFragInNestedFragment) {
+    Teng::Fragment_t data;
+    Teng::Fragment_t& tree = data.addFragment("tree");
+    tree.addVariable(std::string("title"), std::string("T"));
+    add_chain(tree, 3);
+    Teng::Fragment_t& other = data.addFragment("tree");
+    other.addVariable(std::string("title"), std::string("U"));
+    add_chain(other, 1);
+
+    // code after repeat must run in the right frame after return
+    EXPECT_EQ(get_teng_output("<?teng frag tree?>[<?teng frag item?>"
+                              "${name}{<?teng repeatfrag .tree.item?>}${name}"
+                              "<?teng endfrag?>]${title}<?teng endfrag?>",
+                              data),
+              "[n0{n1{n2{}n2}n1}n0]T[n0{}n0]U");
+}
+
+TEST(Teng, RepeatFragMaxDepth) {
+    TempDir_t dir;
+    dir.write("teng.conf", "%maxrepeatdepth 3\n");
+    Teng::Teng_t teng(dir.path, Teng::Teng_t::Settings_t());
+    Teng::Fragment_t data;
+    add_chain(data, 10);
+
+    Teng::Error_t err;
+    EXPECT_EQ(get_teng_output(teng, "<?teng frag item?>(${name}"
+                              "<?teng repeatfrag .item?>)<?teng endfrag?>",
+                              data, err, "teng.conf"),
+              "(n0(n1(n2(n3))))");
+    EXPECT_EQ(count_errors(err, Teng::Error_t::LL_ERROR, "repeated too deep"),
+              1);
+
+    // chain within limit is complete
+    Teng::Fragment_t shallow;
+    add_chain(shallow, 4);
+    Teng::Error_t err2;
+    EXPECT_EQ(get_teng_output(teng, "<?teng frag item?>(${name}"
+                              "<?teng repeatfrag .item?>)<?teng endfrag?>",
+                              shallow, err2, "teng.conf"),
+              "(n0(n1(n2(n3))))");
+    EXPECT_EQ(count_errors(err2, Teng::Error_t::LL_ERROR), 0);
+}
+
+namespace {
+// template reading many undefined variables
+std::string undefined_variables_template() {
+    std::string templ;
+    for (int i = 0; i < 100; ++i) {
+        std::ostringstream var;
+        var << "${undefined" << i << "}";
+        templ += var.str();
+    }
+    // one runtime error
+    return templ + "${1 / 0}";
+}
+}
+
+TEST(Teng, ConfigurationImageDirectives) {
+    Teng::InMemoryFilesystem_t filesystem;
+    filesystem.storage["teng.conf"] =
+        "%disable format\n"
+        "%enable debug\n"
+        "%maxrepeatdepth 7\n"
+        "%loglevel error\n"
+        "key value\n";
+
+    Teng::Configuration_t text("");
+    text.parse(&filesystem, "teng.conf");
+    std::string image;
+    EXPECT_EQ(text.compile(image), 0);
+    filesystem.storage["teng.conf.bin"] = image;
+
+    // directives are replayed when image is loaded
+    Teng::Configuration_t binary("");
+    binary.parse(&filesystem, "teng.conf.bin");
+    EXPECT_FALSE(binary.isFormatEnabled());
+    EXPECT_TRUE(binary.isDebugEnabled());
+    EXPECT_EQ(binary.getMaxRepeatDepth(), 7u);
+    EXPECT_EQ(binary.getLogLevel(), Teng::Error_t::LL_ERROR);
+    ASSERT_TRUE(binary.lookup("key"));
+    EXPECT_EQ(*binary.lookup("key"), "value");
+}
+
+TEST(Teng, DictionaryImageMerge) {
+    Teng::InMemoryFilesystem_t filesystem;
+    filesystem.storage["image.txt"] = "a image a\nb image b\n";
+    Teng::Dictionary_t source("");
+    source.parse(&filesystem, "image.txt");
+    std::string image;
+    EXPECT_EQ(source.compile(image), 0);
+    filesystem.storage["image.dict"] = image;
+
+    // own entries before include => image is merged into the map
+    filesystem.storage["own.dict"] = "a own a\nc own c\n%include image.dict\n";
+    Teng::Dictionary_t merged("");
+    merged.parse(&filesystem, "own.dict");
+    ASSERT_TRUE(merged.lookup("a") && merged.lookup("b") && merged.lookup("c"));
+    EXPECT_EQ(*merged.lookup("a"), "own a");
+    EXPECT_EQ(*merged.lookup("b"), "image b");
+    EXPECT_EQ(*merged.lookup("c"), "own c");
+
+    // replaced by image
+    filesystem.storage["replace.dict"] =
+        "a own a\n%replace yes\n%include image.dict\n";
+    Teng::Dictionary_t replaced("");
+    replaced.parse(&filesystem, "replace.dict");
+    ASSERT_TRUE(replaced.lookup("a"));
+    EXPECT_EQ(*replaced.lookup("a"), "image a");
+}
+
+TEST(Teng, DictionarySharedInclude) {
+    Teng::InMemoryFilesystem_t filesystem;
+    filesystem.storage["base.dict"] = "shared base\nonly base only\n%bogus\n";
+    filesystem.storage["first.dict"] =
+        "%include base.dict\nown first\nshared first\n";
+    filesystem.storage["second.dict"] =
+        "%include base.dict\n%replace yes\nshared second\n";
+    Teng::DictionaryCache_t includeCache;
+    Teng::Dictionary_t first("", &includeCache);
+    first.parse(&filesystem, "first.dict");
+    Teng::Dictionary_t second("", &includeCache);
+    second.parse(&filesystem, "second.dict");
+
+    // included file is parsed once and shared
+    ASSERT_TRUE(first.lookup("only") && second.lookup("only"));
+    EXPECT_EQ(*first.lookup("only"), "base only");
+    EXPECT_EQ(first.lookup("only"), second.lookup("only"));
+
+    // own entries are found, base keeps the first definition
+    ASSERT_TRUE(first.lookup("own") && first.lookup("shared"));
+    EXPECT_EQ(*first.lookup("own"), "first");
+    EXPECT_EQ(*first.lookup("shared"), "base");
+    EXPECT_EQ(second.lookup("own"), (const std::string*)0);
+
+    // %replace yes overrides base
+    ASSERT_TRUE(second.lookup("shared"));
+    EXPECT_EQ(*second.lookup("shared"), "second");
+
+    // errors of included file are reported by both dictionaries
+    EXPECT_EQ(count_errors(first.getErrors(), Teng::Error_t::LL_ERROR,
+                           "Unknown procesing directive"), 1);
+    EXPECT_EQ(count_errors(second.getErrors(), Teng::Error_t::LL_ERROR,
+                           "Unknown procesing directive"), 1);
+}
+
+TEST(Teng, LogLevelSettings) {
+    Teng::Fragment_t data;
+    std::string templ = undefined_variables_template();
+
+    Teng::Teng_t all("", Teng::Teng_t::Settings_t());
+    Teng::Error_t allErr;
+    get_teng_output(all, templ, data, allErr);
+    EXPECT_EQ(count_errors(allErr, Teng::Error_t::LL_WARNING), 100);
+    EXPECT_EQ(count_errors(allErr, Teng::Error_t::LL_ERROR), 1);
+
+    Teng::Teng_t::Settings_t settings;
+    settings.logLevel = Teng::Error_t::LL_ERROR;
+    Teng::Teng_t errors("", settings);
+    Teng::Error_t err;
+    get_teng_output(errors, templ, data, err);
+    EXPECT_EQ(count_errors(err, Teng::Error_t::LL_WARNING), 0);
+    EXPECT_EQ(count_errors(err, Teng::Error_t::LL_ERROR), 1);
+}
+
+TEST(Teng, LogLevelConfiguration) {
+    TempDir_t dir;
+    dir.write("teng.conf", "%loglevel error\n");
+    Teng::Teng_t teng(dir.path, Teng::Teng_t::Settings_t());
+    Teng::Fragment_t data;
+
+    Teng::Error_t err;
+    get_teng_output(teng, undefined_variables_template(), data, err,
+                    "teng.conf");
+    EXPECT_EQ(count_errors(err, Teng::Error_t::LL_WARNING), 0);
+    EXPECT_EQ(count_errors(err, Teng::Error_t::LL_ERROR), 1);
+}
+
 int main(int argc, char** argv)
 {
     /*The method is initializes the Google framework and must be called before RUN_ALL_TESTS */